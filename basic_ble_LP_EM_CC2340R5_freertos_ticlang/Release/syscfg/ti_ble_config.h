@@ -47,7 +47,29 @@ extern uint8_t pRandomAddress[B_ADDR_LEN];
 
 // Maximum size in bytes of the BLE HCI PDU. Valid range: 27 to 255
 // The maximum ATT_MTU is MAX_PDU_SIZE - 4.
-#define MAX_PDU_SIZE                  		    69
+#define MAX_PDU_SIZE                  		    255
+
+/*********************************************************************
+ * L2CAP Connection Oriented Channels Configuration
+ */
+
+#define L2CAPCOC_INITIATOR                    0
+#define L2CAPCOC_RESPONDER                    1
+
+// Which side sends the L2CAP credit based connection request
+#define L2CAP_CONN_ESTABLISH_ROLE             L2CAPCOC_RESPONDER
+
+// Local and peer Protocol/Service Multiplexer
+#define L2CAP_PSM_ID                          0x0080
+#define L2CAP_PEER_PSM_ID                     0x0080
+
+// Largest SDU and PDU payload accepted on the channel
+#define L2CAP_MAX_MTU                         251
+#define L2CAP_MAX_MPS                         251
+
+// Credits given to the peer, and the count at which more are sent
+#define L2CAP_NOF_CREDITS                     10
+#define L2CAP_CREDITS_THRESHOLD               2
 
 /*********************************************************************
  * Bond Manager Configuration
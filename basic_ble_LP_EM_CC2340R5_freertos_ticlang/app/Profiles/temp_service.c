@@ -0,0 +1,445 @@
+/******************************************************************************
+
+@file  temp_service.c
+
+@brief Thermocouple temperature GATT service: latest reading and a
+       notification stream of packed samples, see temp_service.h for the
+       value layouts.
+
+*****************************************************************************/
+
+//*****************************************************************************
+//! Includes
+//*****************************************************************************
+#include <string.h>
+#include <ti/drivers/dpl/ClockP.h>
+#include "ti/ble/app_util/framework/bleapputil_api.h"
+#include "ti/ble/host/gatt/gatt_uuid.h"
+#include "ti/ble/host/gatt/gattservapp.h"
+#include <app_main.h>
+#include "temp_service.h"
+
+//*****************************************************************************
+//! Prototypes
+//*****************************************************************************
+static bStatus_t TempService_readAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
+                                        uint8_t *pValue, uint16_t *pLen,
+                                        uint16_t offset, uint16_t maxLen,
+                                        uint8_t method);
+static bStatus_t TempService_writeAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
+                                         uint8_t *pValue, uint16_t len,
+                                         uint16_t offset, uint8_t method);
+static void TempService_notify(char *pData);
+static void TempService_flush(char *pData);
+static void TempService_flushClockCB(uintptr_t arg);
+static uint8_t TempService_batchLimit(void);
+
+//*****************************************************************************
+//! Globals
+//*****************************************************************************
+
+// Temperature service UUID
+static CONST uint8_t tempServiceUUID[ATT_BT_UUID_SIZE] =
+{
+  LO_UINT16(TEMPSERVICE_SERV_UUID), HI_UINT16(TEMPSERVICE_SERV_UUID)
+};
+
+// Stream characteristic UUID
+static CONST uint8_t tempStreamUUID[ATT_BT_UUID_SIZE] =
+{
+  LO_UINT16(TEMPSERVICE_STREAM_UUID), HI_UINT16(TEMPSERVICE_STREAM_UUID)
+};
+
+// Temperature characteristic UUID
+static CONST uint8_t tempValueUUID[ATT_BT_UUID_SIZE] =
+{
+  LO_UINT16(TEMPSERVICE_TEMP_UUID), HI_UINT16(TEMPSERVICE_TEMP_UUID)
+};
+
+static CONST gattAttrType_t tempService = { ATT_BT_UUID_SIZE, tempServiceUUID };
+
+// Stream characteristic: notify only. The value is the batch of records
+// for the next notification.
+static uint8_t tempStreamProps = GATT_PROP_NOTIFY;
+static uint8_t tempStreamValue[TEMPSERVICE_STREAM_LEN * TEMPSERVICE_STREAM_MAX_RECS] = {0};
+static uint8_t tempStreamCount;
+static ClockP_Struct tempStreamClock;
+static gattCharCfg_t *tempStreamConfig;
+static uint8_t tempStreamUserDesc[] = "Temperature stream";
+
+// Temperature characteristic: read only
+static uint8_t tempValueProps = GATT_PROP_READ;
+static uint8_t tempValue[TEMPSERVICE_TEMP_LEN] = {0};
+static uint8_t tempValueUserDesc[] = "Temperature";
+
+// Sequence number of the next published sample
+static uint16_t tempStreamSeq;
+
+static gattAttribute_t tempServiceAttrTbl[] =
+{
+  // Temperature service
+  {
+    { ATT_BT_UUID_SIZE, primaryServiceUUID },
+    GATT_PERMIT_READ,
+    0,
+    (uint8_t *)&tempService
+  },
+
+    // Stream characteristic declaration
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &tempStreamProps
+    },
+
+      // Stream value, only sent as notifications
+      {
+        { ATT_BT_UUID_SIZE, tempStreamUUID },
+        0,
+        0,
+        tempStreamValue
+      },
+
+      // Stream client characteristic configuration
+      {
+        { ATT_BT_UUID_SIZE, clientCharCfgUUID },
+        GATT_PERMIT_READ | GATT_PERMIT_WRITE,
+        0,
+        (uint8_t *)&tempStreamConfig
+      },
+
+      // Stream user description
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        tempStreamUserDesc
+      },
+
+    // Temperature characteristic declaration
+    {
+      { ATT_BT_UUID_SIZE, characterUUID },
+      GATT_PERMIT_READ,
+      0,
+      &tempValueProps
+    },
+
+      // Temperature value
+      {
+        { ATT_BT_UUID_SIZE, tempValueUUID },
+        GATT_PERMIT_READ,
+        0,
+        tempValue
+      },
+
+      // Temperature user description
+      {
+        { ATT_BT_UUID_SIZE, charUserDescUUID },
+        GATT_PERMIT_READ,
+        0,
+        tempValueUserDesc
+      },
+};
+
+static CONST gattServiceCBs_t tempServiceCBs =
+{
+  TempService_readAttrCB,  // Read callback function pointer
+  TempService_writeAttrCB, // Write callback function pointer
+  NULL                     // Authorization callback function pointer
+};
+
+//*****************************************************************************
+//! Functions
+//*****************************************************************************
+
+/*********************************************************************
+ * @fn      TempService_readAttrCB
+ *
+ * @brief   Read an attribute. Also used by GATTServApp_ProcessCharCfg
+ *          to fetch the value it notifies.
+ *
+ * @return  SUCCESS, blePending or Failure
+ */
+static bStatus_t TempService_readAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
+                                        uint8_t *pValue, uint16_t *pLen,
+                                        uint16_t offset, uint16_t maxLen,
+                                        uint8_t method)
+{
+  uint16_t uuid;
+
+  if (offset > 0)
+  {
+    return ATT_ERR_ATTR_NOT_LONG;
+  }
+
+  uuid = BUILD_UINT16(pAttr->type.uuid[0], pAttr->type.uuid[1]);
+  if (uuid == TEMPSERVICE_STREAM_UUID && maxLen >= TEMPSERVICE_STREAM_LEN)
+  {
+    // Whole records only, should the MTU have shrunk below the batch
+    uint16_t len = tempStreamCount * TEMPSERVICE_STREAM_LEN;
+
+    if (len > maxLen)
+    {
+      len = maxLen - maxLen % TEMPSERVICE_STREAM_LEN;
+    }
+    *pLen = len;
+    memcpy(pValue, pAttr->pValue, len);
+    return SUCCESS;
+  }
+  if (uuid == TEMPSERVICE_TEMP_UUID && maxLen >= TEMPSERVICE_TEMP_LEN)
+  {
+    *pLen = TEMPSERVICE_TEMP_LEN;
+    memcpy(pValue, pAttr->pValue, TEMPSERVICE_TEMP_LEN);
+    return SUCCESS;
+  }
+
+  *pLen = 0;
+  return ATT_ERR_ATTR_NOT_FOUND;
+}
+
+/*********************************************************************
+ * @fn      TempService_writeAttrCB
+ *
+ * @brief   Write an attribute; only the stream CCCD is writable.
+ *
+ * @return  SUCCESS, blePending or Failure
+ */
+static bStatus_t TempService_writeAttrCB(uint16_t connHandle, gattAttribute_t *pAttr,
+                                         uint8_t *pValue, uint16_t len,
+                                         uint16_t offset, uint8_t method)
+{
+  uint16_t uuid = BUILD_UINT16(pAttr->type.uuid[0], pAttr->type.uuid[1]);
+  bStatus_t status;
+
+  if (uuid == GATT_CLIENT_CHAR_CFG_UUID)
+  {
+    status = GATTServApp_ProcessCCCWriteReq(connHandle, pAttr, pValue, len,
+                                            offset, GATT_CLIENT_CFG_NOTIFY);
+
+    // A subscribed client gets every sample: ask for a fast connection
+    if (status == SUCCESS)
+    {
+      Connection_setDemand(connHandle, APP_CONN_DEMAND_STREAM,
+                           (pValue[0] & GATT_CLIENT_CFG_NOTIFY) != 0);
+    }
+    return status;
+  }
+
+  return ATT_ERR_ATTR_NOT_FOUND;
+}
+
+/*********************************************************************
+ * @fn      TempService_batchLimit
+ *
+ * @brief   Records that fit one notification to every subscriber, from
+ *          the ATT MTU negotiated on each connection.
+ *
+ * @return  1 to TEMPSERVICE_STREAM_MAX_RECS
+ */
+static uint8_t TempService_batchLimit(void)
+{
+  uint16_t limit = TEMPSERVICE_STREAM_MAX_RECS;
+  uint16_t fit;
+  uint8_t i;
+
+  for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
+  {
+    if (tempStreamConfig[i].connHandle != LINKDB_CONNHANDLE_INVALID &&
+        (tempStreamConfig[i].value & GATT_CLIENT_CFG_NOTIFY))
+    {
+      // Notification header: opcode and handle
+      fit = (Connection_getMtu(tempStreamConfig[i].connHandle) - 3) / TEMPSERVICE_STREAM_LEN;
+      if (fit < limit)
+      {
+        limit = fit;
+      }
+    }
+  }
+
+  return limit > 0 ? limit : 1;
+}
+
+/*********************************************************************
+ * @fn      TempService_flush
+ *
+ * @brief   Runs in the BLE app task: notify the batched records to every
+ *          subscribed client and start a new batch.
+ *
+ * @param   pData - unused
+ *
+ * @return  none
+ */
+static void TempService_flush(char *pData)
+{
+  ClockP_stop(ClockP_handle(&tempStreamClock));
+
+  if (tempStreamCount == 0)
+  {
+    return;
+  }
+
+  GATTServApp_ProcessCharCfg(tempStreamConfig, tempStreamValue, FALSE,
+                             tempServiceAttrTbl, GATT_NUM_ATTRS(tempServiceAttrTbl),
+                             INVALID_TASKID, TempService_readAttrCB);
+  tempStreamCount = 0;
+}
+
+/*********************************************************************
+ * @fn      TempService_flushClockCB
+ *
+ * @brief   The oldest batched record waited long enough; flush in the
+ *          BLE app task.
+ *
+ * @param   arg - unused
+ *
+ * @return  none
+ */
+static void TempService_flushClockCB(uintptr_t arg)
+{
+  BLEAppUtil_invokeFunction(TempService_flush, NULL);
+}
+
+/*********************************************************************
+ * @fn      TempService_notify
+ *
+ * @brief   Runs in the BLE app task: take the record packed by
+ *          TempService_publish, update the temperature value from it
+ *          for channel 0 and add it to the notification batch, sending
+ *          the batch once it fills the ATT MTU.
+ *
+ * @param   pData - the queued sample, freed by BLEAppUtil afterwards
+ *
+ * @return  none
+ */
+static void TempService_notify(char *pData)
+{
+  const uint8_t *pRec = (const uint8_t *)pData;
+  uint8_t limit;
+
+  // Reads are served from this task too, so they see all of it or none
+  if (pRec[6] == 0)
+  {
+    memcpy(&tempValue[0], &pRec[7], 4);   // thermocouple
+    tempValue[4] = pRec[13];              // fault status
+    memcpy(&tempValue[5], &pRec[11], 2);  // cold junction
+  }
+
+  if (!TempService_subscribed())
+  {
+    tempStreamCount = 0;
+    return;
+  }
+
+  // A subscriber with a smaller MTU may have joined since the last record
+  limit = TempService_batchLimit();
+  if (tempStreamCount >= limit)
+  {
+    TempService_flush(NULL);
+  }
+
+  memcpy(&tempStreamValue[tempStreamCount * TEMPSERVICE_STREAM_LEN], pRec,
+         TEMPSERVICE_STREAM_LEN);
+  tempStreamCount++;
+
+  if (tempStreamCount >= limit)
+  {
+    TempService_flush(NULL);
+  }
+  else if (tempStreamCount == 1)
+  {
+    ClockP_start(ClockP_handle(&tempStreamClock));
+  }
+}
+
+/*********************************************************************
+ * @fn      TempService_start
+ */
+bStatus_t TempService_start(void)
+{
+  ClockP_Params clockParams;
+
+  // One-shot, bounds how long a record waits in the batch
+  ClockP_Params_init(&clockParams);
+  ClockP_construct(&tempStreamClock, TempService_flushClockCB,
+                   (TEMPSERVICE_STREAM_LATENCY_MS * 1000) / ClockP_getSystemTickPeriod(),
+                   &clockParams);
+
+  tempStreamConfig = (gattCharCfg_t *)BLEAppUtil_malloc(sizeof(gattCharCfg_t) *
+                                                        MAX_NUM_BLE_CONNS);
+  if (tempStreamConfig == NULL)
+  {
+    return bleMemAllocError;
+  }
+  GATTServApp_InitCharCfg(LINKDB_CONNHANDLE_INVALID, tempStreamConfig);
+
+  return GATTServApp_RegisterService(tempServiceAttrTbl,
+                                     GATT_NUM_ATTRS(tempServiceAttrTbl),
+                                     GATT_MAX_ENCRYPT_KEY_SIZE,
+                                     &tempServiceCBs);
+}
+
+/*********************************************************************
+ * @fn      TempService_subscribed
+ */
+bool TempService_subscribed(void)
+{
+  uint8_t i;
+
+  if (tempStreamConfig == NULL)
+  {
+    return false;
+  }
+
+  // Plain reads of entries the BLE task owns; a stale answer only costs
+  // one sample
+  for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
+  {
+    if (tempStreamConfig[i].connHandle != LINKDB_CONNHANDLE_INVALID &&
+        (tempStreamConfig[i].value & GATT_CLIENT_CFG_NOTIFY))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*********************************************************************
+ * @fn      TempService_publish
+ */
+bStatus_t TempService_publish(const TempService_Sample *pSample)
+{
+  uint8_t *pRec = (uint8_t *)BLEAppUtil_malloc(TEMPSERVICE_STREAM_LEN);
+  uint16_t seq = tempStreamSeq++;
+  uint32_t ts = pSample->timestampMs;
+  uint32_t tc = (uint32_t)pSample->tcCenti;
+  uint16_t cj = (uint16_t)pSample->cjCenti;
+
+  // Counted even when dropped, so the client sees the gap
+  if (pRec == NULL)
+  {
+    return bleMemAllocError;
+  }
+
+  pRec[0]  = LO_UINT16(seq);
+  pRec[1]  = HI_UINT16(seq);
+  pRec[2]  = BREAK_UINT32(ts, 0);
+  pRec[3]  = BREAK_UINT32(ts, 1);
+  pRec[4]  = BREAK_UINT32(ts, 2);
+  pRec[5]  = BREAK_UINT32(ts, 3);
+  pRec[6]  = pSample->channel;
+  pRec[7]  = BREAK_UINT32(tc, 0);
+  pRec[8]  = BREAK_UINT32(tc, 1);
+  pRec[9]  = BREAK_UINT32(tc, 2);
+  pRec[10] = BREAK_UINT32(tc, 3);
+  pRec[11] = LO_UINT16(cj);
+  pRec[12] = HI_UINT16(cj);
+  pRec[13] = pSample->fault;
+
+  if (BLEAppUtil_invokeFunction(TempService_notify, (char *)pRec) != SUCCESS)
+  {
+    BLEAppUtil_free(pRec);
+    return bleMemAllocError;
+  }
+  return SUCCESS;
+}
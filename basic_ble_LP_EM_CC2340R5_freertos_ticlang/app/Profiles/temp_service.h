@@ -0,0 +1,119 @@
+/******************************************************************************
+
+@file  temp_service.h
+
+@brief Thermocouple temperature GATT service
+
+ The temperature characteristic holds the latest channel 0 reading for
+ clients that poll, packed little-endian so one read returns a coherent
+ value:
+
+   offset size
+   0      4    thermocouple, int32 centi-degrees C
+   4      1    MAX31856 fault status (SR)
+   5      2    cold junction, int16 centi-degrees C
+
+ The stream characteristic pushes every new sample, of any channel, to
+ subscribed clients as GATT notifications of packed records. Records are
+ batched into as few notifications as the smallest ATT MTU of the
+ subscribers allows, but no record waits longer than
+ TEMPSERVICE_STREAM_LATENCY_MS. A notification is 1 to
+ TEMPSERVICE_STREAM_MAX_RECS records back to back, each:
+
+   offset size
+   0      2    sequence number, +1 per published sample
+   2      4    timestamp, ms since boot (FreeRTOS tick count)
+   6      1    channel, 0 unless several MAX31856 are scanned
+   7      4    thermocouple, int32 centi-degrees C
+   11     2    cold junction, int16 centi-degrees C
+   13     1    MAX31856 fault status (SR)
+
+ A gap in the sequence number means samples were dropped on the node.
+
+*****************************************************************************/
+
+#ifndef TEMP_SERVICE_H_
+#define TEMP_SERVICE_H_
+
+//*****************************************************************************
+//! Includes
+//*****************************************************************************
+#include <stdbool.h>
+#include <stdint.h>
+#include "ti/ble/app_util/framework/bleapputil_api.h"
+
+//*****************************************************************************
+//! Defines
+//*****************************************************************************
+
+// Service and characteristic UUIDs
+#define TEMPSERVICE_SERV_UUID       0xFFE0
+#define TEMPSERVICE_STREAM_UUID     0xFFE1
+#define TEMPSERVICE_TEMP_UUID       0xFFE2
+
+// Lengths of the packed values
+#define TEMPSERVICE_STREAM_LEN      14
+#define TEMPSERVICE_TEMP_LEN        7
+
+// Most stream records per notification: (247 - 3) / 14, so one
+// notification fills an ATT MTU of 247, one 251-byte LL PDU
+#define TEMPSERVICE_STREAM_MAX_RECS 17
+
+// Longest time a record waits for others to share its notification
+#define TEMPSERVICE_STREAM_LATENCY_MS 200
+
+//*****************************************************************************
+//! Typedefs
+//*****************************************************************************
+typedef struct
+{
+  uint32_t timestampMs;   // when the sample was taken
+  int32_t  tcCenti;       // thermocouple, centi-degrees C
+  int16_t  cjCenti;       // cold junction, centi-degrees C
+  uint8_t  channel;
+  uint8_t  fault;         // MAX31856 SR
+} TempService_Sample;
+
+//*****************************************************************************
+//! Functions
+//*****************************************************************************
+
+/*********************************************************************
+ * @fn      TempService_start
+ *
+ * @brief   This function is called after stack initialization,
+ *          the purpose of this function is to initialize and
+ *          register the temperature service.
+ *
+ * @return  SUCCESS or stack call status
+ */
+bStatus_t TempService_start(void);
+
+/*********************************************************************
+ * @fn      TempService_subscribed
+ *
+ * @brief   Check whether any connected client enabled notifications,
+ *          so producers can skip building samples nobody receives.
+ *          May be called from any task.
+ *
+ * @return  true if at least one client is subscribed
+ */
+bool TempService_subscribed(void);
+
+/*********************************************************************
+ * @fn      TempService_publish
+ *
+ * @brief   Stamp the sample with the next sequence number, make it the
+ *          temperature value if it is from channel 0, and batch it for
+ *          notification to all subscribed clients. May be called from any
+ *          single producer task; the value is updated and the batch sent
+ *          from the BLE app task context, so reads never see a partially
+ *          updated value.
+ *
+ * @param   pSample - sample to send, copied before returning
+ *
+ * @return  SUCCESS, or bleMemAllocError if it could not be queued
+ */
+bStatus_t TempService_publish(const TempService_Sample *pSample);
+
+#endif /* TEMP_SERVICE_H_ */
@@ -0,0 +1,228 @@
+/*
+ *  ======== max31856.c ========
+ */
+#include <string.h>
+
+#include <ti/drivers/GPIO.h>
+
+#include "max31856.h"
+#include "temp_fixed.h"
+
+// Longest register run moved in one transaction: the whole map
+#define MAX31856_XFER_MAX (MAX31856_NUM_REGS)
+
+// CJTH..SR
+#define MAX31856_RESULT_LEN (MAX31856_SR - MAX31856_CJTH + 1)
+
+// CR0 bits that trigger an action rather than hold configuration
+#define MAX31856_CR0_ACTIONS (MAX31856_CR0_1SHOT | MAX31856_CR0_FAULTCLR)
+
+/*
+ *  ======== drdyCallback ========
+ *  DRDY fell: wake the task waiting on this device.
+ */
+static void drdyCallback(uint_least8_t index)
+{
+    Max31856_Device *dev = (Max31856_Device *)GPIO_getUserArg(index);
+    BaseType_t woken = pdFALSE;
+
+    if (dev != NULL && dev->task != NULL) {
+        vTaskNotifyGiveFromISR(dev->task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/*
+ *  ======== max31856_open ========
+ */
+bool max31856_open(Max31856_Device *dev, SPI_Handle spi, uint_least8_t csGpio,
+                   uint_least8_t drdyGpio, const Max31856_Config *cfg)
+{
+    memset(dev, 0, sizeof(*dev));
+    dev->spi = spi;
+    dev->csGpio = csGpio;
+    dev->drdyGpio = drdyGpio;
+    dev->cfg = *cfg;
+    dev->task = xTaskGetCurrentTaskHandle();
+
+    GPIO_setConfig(csGpio, GPIO_CFG_OUT_STD | GPIO_CFG_OUT_HIGH);
+
+    if (!max31856_configure(dev)) {
+        return false;
+    }
+
+    if (drdyGpio == GPIO_INVALID_INDEX) {
+        return true;
+    }
+
+    // Armed after configuring so a stale DRDY from before reset is not
+    // mistaken for a result; max31856_wait() checks the level anyway.
+    GPIO_setConfig(drdyGpio, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
+    GPIO_setUserArg(drdyGpio, dev);
+    GPIO_setCallback(drdyGpio, drdyCallback);
+    GPIO_enableInt(drdyGpio);
+
+    return true;
+}
+
+/*
+ *  ======== max31856_configure ========
+ */
+bool max31856_configure(Max31856_Device *dev)
+{
+    uint8_t cr[2];
+
+    cr[0] = (dev->cfg.cr0 & ~MAX31856_CR0_ACTIONS) | MAX31856_CR0_FAULTCLR;
+    cr[1] = dev->cfg.cr1;
+    if (!max31856_write_reg(dev, MAX31856_CR0, cr, sizeof(cr))) {
+        return false;
+    }
+
+    // Read back: a missing or miswired chip returns 0x00 or 0xFF
+    if (!max31856_read_reg(dev, MAX31856_CR0, cr, sizeof(cr))) {
+        return false;
+    }
+    return (cr[0] & ~MAX31856_CR0_ACTIONS) == (dev->cfg.cr0 & ~MAX31856_CR0_ACTIONS) &&
+           cr[1] == dev->cfg.cr1;
+}
+
+/*
+ *  ======== max31856_conversion_ms ========
+ */
+uint32_t max31856_conversion_ms(const Max31856_Config *cfg)
+{
+    uint8_t avgSel = (cfg->cr1 & MAX31856_CR1_AVG_MASK) >> 4;
+    uint32_t samples = avgSel >= 4 ? 16 : (uint32_t)1 << avgSel;
+    bool continuous = (cfg->cr0 & MAX31856_CR0_CMODE) != 0;
+
+    // Datasheet maxima for one sample at 60/50 Hz rejection: 90/110 ms
+    // continuous, 155/185 ms one-shot; each further averaged sample adds
+    // 33.3/40 ms
+    if (cfg->cr0 & MAX31856_CR0_50HZ) {
+        return (continuous ? 110 : 185) + (samples - 1) * 40;
+    }
+    return (continuous ? 90 : 155) + (samples - 1) * 34;
+}
+
+/*
+ *  ======== max31856_start_oneshot ========
+ */
+bool max31856_start_oneshot(Max31856_Device *dev)
+{
+    uint8_t cr0 = (dev->cfg.cr0 & ~(MAX31856_CR0_CMODE | MAX31856_CR0_ACTIONS)) |
+                  MAX31856_CR0_1SHOT;
+
+    return max31856_write_reg(dev, MAX31856_CR0, &cr0, 1);
+}
+
+/*
+ *  ======== max31856_wait ========
+ */
+bool max31856_wait(Max31856_Device *dev, TickType_t timeout, Max31856_Sample *sample)
+{
+    TickType_t start = xTaskGetTickCount();
+
+    // The level decides, so notifications left over from a sample that was
+    // already read, or from the edge racing this check, are harmless.
+    while (GPIO_read(dev->drdyGpio) != 0) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+
+        if (elapsed >= timeout) {
+            dev->timeouts++;
+            max31856_configure(dev);
+            return false;
+        }
+        ulTaskNotifyTake(pdTRUE, timeout - elapsed);
+    }
+
+    if (!max31856_read_sample(dev, sample)) {
+        return false;
+    }
+    dev->samples++;
+
+    return true;
+}
+
+/*
+ *  ======== max31856_read_sample ========
+ */
+bool max31856_read_sample(Max31856_Device *dev, Max31856_Sample *sample)
+{
+    uint8_t buf[MAX31856_RESULT_LEN];
+    const uint8_t *cj = buf;
+    const uint8_t *tc = &buf[MAX31856_LTCBH - MAX31856_CJTH];
+
+    if (!max31856_read_reg(dev, MAX31856_CJTH, buf, sizeof(buf))) {
+        return false;
+    }
+
+    // Both values are left-justified two's complement: drop the unused low
+    // bits (D1..D0 of CJT, D4..D0 of LTCB), then sign-extend
+    sample->cjRaw = (int16_t)temp_fixed_sext(((uint32_t)cj[0] << 6) | (cj[1] >> 2), 14);
+    sample->tcRaw = temp_fixed_sext(((uint32_t)tc[0] << 11) | ((uint32_t)tc[1] << 3) |
+                                    (tc[2] >> 5), 19);
+    sample->fault = buf[MAX31856_SR - MAX31856_CJTH];
+
+    return true;
+}
+
+/*
+ *  ======== max31856_write_reg ========
+ */
+bool max31856_write_reg(Max31856_Device *dev, uint8_t reg, const uint8_t *buf, uint16_t len)
+{
+    SPI_Transaction trans;
+    uint8_t txBuf[1 + MAX31856_XFER_MAX];
+    bool ok;
+
+    if (len > MAX31856_XFER_MAX) {
+        return false;
+    }
+
+    // MSB=1 → write
+    txBuf[0] = reg | MAX31856_WRITE;
+    memcpy(&txBuf[1], buf, len);
+
+    memset(&trans, 0, sizeof(trans));
+    trans.count = 1 + len;
+    trans.txBuf = txBuf;
+    trans.rxBuf = NULL;
+
+    GPIO_write(dev->csGpio, 0);
+    ok = SPI_transfer(dev->spi, &trans);
+    GPIO_write(dev->csGpio, 1);
+
+    return ok;
+}
+
+/*
+ *  ======== max31856_read_reg ========
+ */
+bool max31856_read_reg(Max31856_Device *dev, uint8_t reg, uint8_t *buf, uint16_t len)
+{
+    SPI_Transaction trans;
+    uint8_t txBuf[1 + MAX31856_XFER_MAX] = {0};
+    uint8_t rxBuf[1 + MAX31856_XFER_MAX];
+    bool ok;
+
+    if (len > MAX31856_XFER_MAX) {
+        return false;
+    }
+
+    // MSB=0 → read
+    txBuf[0] = reg & ~MAX31856_WRITE;
+
+    memset(&trans, 0, sizeof(trans));
+    trans.count = 1 + len;
+    trans.txBuf = txBuf;
+    trans.rxBuf = rxBuf;
+
+    GPIO_write(dev->csGpio, 0);
+    ok = SPI_transfer(dev->spi, &trans);
+    GPIO_write(dev->csGpio, 1);
+
+    if (ok) {
+        memcpy(buf, &rxBuf[1], len);  // skip the address byte
+    }
+    return ok;
+}
@@ -0,0 +1,155 @@
+/*
+ *  ======== max31856.h ========
+ *  MAX31856 thermocouple-to-digital converter on the SPI controller.
+ *
+ *  The chip is configured once at open and left converting continuously.
+ *  DRDY (active low) is wired to a GPIO interrupt that wakes the reading
+ *  task, so a sample is taken exactly when a conversion completes and each
+ *  sample costs a single SPI transaction: one auto-increment burst over
+ *  CJTH..SR gives a coherent cold-junction, thermocouple and fault
+ *  snapshot. Reading LTCBH clears DRDY.
+ */
+#ifndef MAX31856_H_
+#define MAX31856_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <ti/drivers/SPI.h>
+
+// Register addresses, OR with MAX31856_WRITE to write
+#define MAX31856_CR0    (0x00)
+#define MAX31856_CR1    (0x01)
+#define MAX31856_MASK   (0x02)
+#define MAX31856_CJTH   (0x0A)
+#define MAX31856_CJTL   (0x0B)
+#define MAX31856_LTCBH  (0x0C)
+#define MAX31856_LTCBM  (0x0D)
+#define MAX31856_LTCBL  (0x0E)
+#define MAX31856_SR     (0x0F)
+#define MAX31856_NUM_REGS (0x10)
+#define MAX31856_WRITE  (0x80)
+
+// CR0
+#define MAX31856_CR0_CMODE    (0x80)  // continuous conversion
+#define MAX31856_CR0_1SHOT    (0x40)
+#define MAX31856_CR0_OCFAULT  (0x10)  // open-circuit detection, Rs < 5k
+#define MAX31856_CR0_CJ       (0x08)  // cold-junction sensor disabled
+#define MAX31856_CR0_FAULTCLR (0x02)
+#define MAX31856_CR0_50HZ     (0x01)  // else 60 Hz rejection
+
+// CR1 AVGSEL: conversions averaged per result, OR with the type
+#define MAX31856_CR1_AVG_1  (0x00)
+#define MAX31856_CR1_AVG_2  (0x10)
+#define MAX31856_CR1_AVG_4  (0x20)
+#define MAX31856_CR1_AVG_8  (0x30)
+#define MAX31856_CR1_AVG_16 (0x40)
+#define MAX31856_CR1_AVG_MASK (0x70)
+
+// CR1 thermocouple types
+#define MAX31856_TC_B (0x00)
+#define MAX31856_TC_E (0x01)
+#define MAX31856_TC_J (0x02)
+#define MAX31856_TC_K (0x03)
+#define MAX31856_TC_N (0x04)
+#define MAX31856_TC_R (0x05)
+#define MAX31856_TC_S (0x06)
+#define MAX31856_TC_T (0x07)
+
+// SR fault bits
+#define MAX31856_SR_OPEN    (0x01)
+#define MAX31856_SR_OVUV    (0x02)
+#define MAX31856_SR_TCLOW   (0x04)
+#define MAX31856_SR_TCHIGH  (0x08)
+#define MAX31856_SR_CJLOW   (0x10)
+#define MAX31856_SR_CJHIGH  (0x20)
+#define MAX31856_SR_TCRANGE (0x40)
+#define MAX31856_SR_CJRANGE (0x80)
+
+typedef struct
+{
+    uint8_t cr0;  // MAX31856_CR0_xxx, FAULTCLR and 1SHOT are ignored
+    uint8_t cr1;  // MAX31856_CR1_AVG_n | thermocouple type MAX31856_TC_x
+} Max31856_Config;
+
+// Result registers, decoded from one CJTH..SR burst
+typedef struct
+{
+    int16_t cjRaw;  // cold junction, Q6 (1/64 degC)
+    int32_t tcRaw;  // linearized thermocouple, Q7 (1/128 degC)
+    uint8_t fault;  // SR, MAX31856_SR_xxx
+} Max31856_Sample;
+
+typedef struct
+{
+    SPI_Handle      spi;
+    uint_least8_t   csGpio;
+    uint_least8_t   drdyGpio;
+    Max31856_Config cfg;
+    TaskHandle_t    task;      // woken by DRDY
+    uint32_t        samples;
+    uint32_t        timeouts;  // waits that saw no DRDY, chip reconfigured
+} Max31856_Device;
+
+/*
+ *  ======== max31856_open ========
+ *  Bind dev to spi, its CS GPIO and DRDY GPIO, write cfg to the chip and
+ *  check it reads back. DRDY wakes the calling task, which must be the one
+ *  that calls max31856_wait(). Pass GPIO_INVALID_INDEX for a chip without
+ *  DRDY wired; it can only be used through max31856_start_oneshot() and
+ *  max31856_read_sample() on a timer.
+ */
+bool max31856_open(Max31856_Device *dev, SPI_Handle spi, uint_least8_t csGpio,
+                   uint_least8_t drdyGpio, const Max31856_Config *cfg);
+
+/*
+ *  ======== max31856_configure ========
+ *  Write CR0/CR1 from dev->cfg and clear latched faults.
+ */
+bool max31856_configure(Max31856_Device *dev);
+
+/*
+ *  ======== max31856_conversion_ms ========
+ *  Worst-case time from the start of a conversion to its result for cfg:
+ *  one-shot unless CMODE is set, growing with the AVGSEL sample count and
+ *  longer with 50 Hz rejection.
+ */
+uint32_t max31856_conversion_ms(const Max31856_Config *cfg);
+
+/*
+ *  ======== max31856_start_oneshot ========
+ *  Start a single conversion on a chip configured without CMODE. The
+ *  result is ready max31856_conversion_ms() later.
+ */
+bool max31856_start_oneshot(Max31856_Device *dev);
+
+/*
+ *  ======== max31856_wait ========
+ *  Block until a conversion is ready, at most timeout ticks, then read
+ *  it into *sample. On timeout the chip is reconfigured (it may have
+ *  browned out) and false is returned.
+ */
+bool max31856_wait(Max31856_Device *dev, TickType_t timeout, Max31856_Sample *sample);
+
+/*
+ *  ======== max31856_read_sample ========
+ *  Burst-read CJTH..SR in one transaction and decode it into *sample.
+ */
+bool max31856_read_sample(Max31856_Device *dev, Max31856_Sample *sample);
+
+/*
+ *  ======== max31856_read_reg ========
+ *  Read len consecutive registers from reg in one transaction (the address
+ *  auto-increments), up to the whole register map.
+ */
+bool max31856_read_reg(Max31856_Device *dev, uint8_t reg, uint8_t *buf, uint16_t len);
+
+/*
+ *  ======== max31856_write_reg ========
+ *  Write len consecutive registers from reg.
+ */
+bool max31856_write_reg(Max31856_Device *dev, uint8_t reg, const uint8_t *buf, uint16_t len);
+
+#endif /* MAX31856_H_ */
@@ -0,0 +1,96 @@
+/*
+ *  ======== temp_filter.c ========
+ */
+#include <string.h>
+
+#include "temp_filter.h"
+
+/*
+ *  ======== divRound ========
+ *  num / den rounded half away from zero, den > 0.
+ */
+static int32_t divRound(int32_t num, int32_t den)
+{
+    return (num + (num < 0 ? -den / 2 : den / 2)) / den;
+}
+
+/*
+ *  ======== temp_filter_init ========
+ */
+void temp_filter_init(TempFilter *f, const TempFilter_Config *cfg)
+{
+    f->cfg = *cfg;
+    if (f->cfg.window < 1) {
+        f->cfg.window = 1;
+    }
+    else if (f->cfg.window > TEMP_FILTER_WINDOW_MAX) {
+        f->cfg.window = TEMP_FILTER_WINDOW_MAX;
+    }
+    if (f->cfg.shift < 1) {
+        f->cfg.shift = 1;
+    }
+    else if (f->cfg.shift > TEMP_FILTER_SHIFT_MAX) {
+        f->cfg.shift = TEMP_FILTER_SHIFT_MAX;
+    }
+    if (f->cfg.decimation < 1) {
+        f->cfg.decimation = 1;
+    }
+    temp_filter_reset(f);
+}
+
+/*
+ *  ======== temp_filter_reset ========
+ */
+void temp_filter_reset(TempFilter *f)
+{
+    memset(f->hist, 0, sizeof(f->hist));
+    f->acc = 0;
+    f->fill = 0;
+    f->next = 0;
+    f->phase = 0;
+}
+
+/*
+ *  ======== temp_filter_push ========
+ */
+bool temp_filter_push(TempFilter *f, int32_t centi, int32_t *out)
+{
+    int32_t y;
+
+    switch (f->cfg.kind) {
+    case TempFilter_MOVING_AVG:
+        // Running sum: add the newest, drop the one leaving the window.
+        // Until the window fills, average what there is.
+        f->acc += centi - f->hist[f->next];
+        f->hist[f->next] = centi;
+        f->next = (f->next + 1) % f->cfg.window;
+        if (f->fill < f->cfg.window) {
+            f->fill++;
+        }
+        y = divRound(f->acc, f->fill);
+        break;
+
+    case TempFilter_IIR:
+        // Seeded with the first input so it does not ramp up from zero
+        if (f->fill == 0) {
+            f->acc = centi * ((int32_t)1 << f->cfg.shift);
+            f->fill = 1;
+        }
+        else {
+            f->acc += centi - divRound(f->acc, (int32_t)1 << f->cfg.shift);
+        }
+        y = divRound(f->acc, (int32_t)1 << f->cfg.shift);
+        break;
+
+    default:
+        y = centi;
+        break;
+    }
+
+    if (++f->phase < f->cfg.decimation) {
+        return false;
+    }
+    f->phase = 0;
+    *out = y;
+    return true;
+}
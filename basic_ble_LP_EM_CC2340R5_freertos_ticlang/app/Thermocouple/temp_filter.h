@@ -0,0 +1,68 @@
+/*
+ *  ======== temp_filter.h ========
+ *  Decimating low-pass filter for centi-degree samples.
+ *
+ *  The MAX31856 can average up to 16 conversions itself (AVGSEL); this
+ *  filters further in firmware and emits one result per `decimation`
+ *  inputs, so only the samples worth sending reach the radio. Two
+ *  integer-only kinds: a moving average over the last `window` inputs, or a
+ *  first-order IIR y += (x - y) / 2^shift.
+ */
+#ifndef TEMP_FILTER_H_
+#define TEMP_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Longest moving-average window
+#define TEMP_FILTER_WINDOW_MAX (16)
+
+// Largest IIR shift: y * 2^12 stays within int32_t up to +-5000 degC
+#define TEMP_FILTER_SHIFT_MAX (12)
+
+typedef enum
+{
+    TempFilter_NONE,        // pass through, decimation still applies
+    TempFilter_MOVING_AVG,
+    TempFilter_IIR,
+} TempFilter_Kind;
+
+typedef struct
+{
+    TempFilter_Kind kind;
+    uint8_t         window;      // MOVING_AVG: inputs averaged, 1..WINDOW_MAX
+    uint8_t         shift;       // IIR: time constant of 2^shift inputs, 1..SHIFT_MAX
+    uint16_t        decimation;  // inputs per output, 1 = every input
+} TempFilter_Config;
+
+typedef struct
+{
+    TempFilter_Config cfg;
+    int32_t  hist[TEMP_FILTER_WINDOW_MAX];  // MOVING_AVG inputs, circular
+    int32_t  acc;     // MOVING_AVG: sum of hist; IIR: y * 2^shift
+    uint8_t  fill;    // inputs since reset, saturating at the window
+    uint8_t  next;    // MOVING_AVG: slot of the oldest input
+    uint16_t phase;   // inputs since the last output
+} TempFilter;
+
+/*
+ *  ======== temp_filter_init ========
+ *  Set f up with cfg, clamping out-of-range fields, and reset it.
+ */
+void temp_filter_init(TempFilter *f, const TempFilter_Config *cfg);
+
+/*
+ *  ======== temp_filter_reset ========
+ *  Forget the history, e.g. after a sensor fault; the next input restarts
+ *  the filter and the decimation phase.
+ */
+void temp_filter_reset(TempFilter *f);
+
+/*
+ *  ======== temp_filter_push ========
+ *  Feed one input. Returns true, with the filtered value in *out, on every
+ *  decimation'th input.
+ */
+bool temp_filter_push(TempFilter *f, int32_t centi, int32_t *out);
+
+#endif /* TEMP_FILTER_H_ */
@@ -0,0 +1,65 @@
+/*
+ *  ======== temp_fixed.c ========
+ */
+#include "temp_fixed.h"
+
+/*
+ *  ======== temp_fixed_sext ========
+ */
+int32_t temp_fixed_sext(uint32_t v, uint8_t bits)
+{
+    uint32_t sign = (uint32_t)1 << (bits - 1);
+
+    // Flip the sign bit then subtract its weight: no implementation-defined
+    // shifts of negative values
+    v &= (sign << 1) - 1;
+    return (int32_t)(v ^ sign) - (int32_t)sign;
+}
+
+/*
+ *  ======== temp_fixed_from_q ========
+ */
+int32_t temp_fixed_from_q(int32_t raw, uint8_t fracBits)
+{
+    int32_t half = (int32_t)1 << (fracBits - 1);
+
+    // raw * 100 / 2^fracBits; division truncates toward zero, so bias by
+    // half a unit away from zero first. raw is at most 19 bits here.
+    return (raw * 100 + (raw < 0 ? -half : half)) / ((int32_t)1 << fracBits);
+}
+
+/*
+ *  ======== temp_fixed_format ========
+ */
+uint8_t temp_fixed_format(int32_t centi, char *text, uint8_t size)
+{
+    char buf[TEMP_FIXED_TEXT_MAX - 1];
+    uint32_t mag = centi < 0 ? 0u - (uint32_t)centi : (uint32_t)centi;
+    uint8_t pos = sizeof(buf);
+    uint8_t len;
+    uint8_t i;
+
+    // Built backwards from the last digit: two decimals, the point, then
+    // at least one whole digit
+    buf[--pos] = '0' + mag % 10;
+    mag /= 10;
+    buf[--pos] = '0' + mag % 10;
+    mag /= 10;
+    buf[--pos] = '.';
+    do {
+        buf[--pos] = '0' + mag % 10;
+        mag /= 10;
+    } while (mag != 0);
+    if (centi < 0) {
+        buf[--pos] = '-';
+    }
+
+    len = sizeof(buf) - pos;
+    if (size != 0) {
+        for (i = 0; i < len && i < size - 1; i++) {
+            text[i] = buf[pos + i];
+        }
+        text[i] = '\0';
+    }
+    return len;
+}
@@ -0,0 +1,38 @@
+/*
+ *  ======== temp_fixed.h ========
+ *  Integer-only temperature arithmetic for the Cortex-M0+, which has no
+ *  FPU: every temperature the application produces is an int32_t in
+ *  centi-degrees Celsius (45022 = 450.22 degC), converted from the sensors'
+ *  binary fractions and formatted as decimal text without soft-float or
+ *  printf.
+ */
+#ifndef TEMP_FIXED_H_
+#define TEMP_FIXED_H_
+
+#include <stdint.h>
+
+// Longest text temp_fixed_format() writes: "-21474836.48" and the NUL
+#define TEMP_FIXED_TEXT_MAX (13)
+
+/*
+ *  ======== temp_fixed_sext ========
+ *  Sign-extend the low bits of v, a two's complement field of that width.
+ */
+int32_t temp_fixed_sext(uint32_t v, uint8_t bits);
+
+/*
+ *  ======== temp_fixed_from_q ========
+ *  Convert raw, in 1/2^fracBits degC, to centi-degrees, rounding half away
+ *  from zero. The MAX31856 thermocouple is Q7 (1/128), its cold junction
+ *  Q6 (1/64).
+ */
+int32_t temp_fixed_from_q(int32_t raw, uint8_t fracBits);
+
+/*
+ *  ======== temp_fixed_format ========
+ *  Write centi as "[-]d.dd" into text, NUL-terminated and truncated to
+ *  size like snprintf(). Returns the length of the full text.
+ */
+uint8_t temp_fixed_format(int32_t centi, char *text, uint8_t size);
+
+#endif /* TEMP_FIXED_H_ */
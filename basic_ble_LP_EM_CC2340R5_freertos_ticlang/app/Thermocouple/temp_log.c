@@ -0,0 +1,86 @@
+/*
+ *  ======== temp_log.c ========
+ */
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "temp_log.h"
+
+static TempLog_Record logRecords[TEMP_LOG_DEPTH];
+
+// Index of the next record to append; records [next - fill, next) are kept
+static uint32_t logNext;
+static uint32_t logFill;
+
+/*
+ *  ======== temp_log_append ========
+ */
+void temp_log_append(const TempLog_Record *rec)
+{
+    taskENTER_CRITICAL();
+    logRecords[logNext % TEMP_LOG_DEPTH] = *rec;
+    logNext++;
+    if (logFill < TEMP_LOG_DEPTH) {
+        logFill++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*
+ *  ======== temp_log_find ========
+ */
+uint32_t temp_log_find(uint32_t fromMs)
+{
+    uint32_t lo;
+    uint32_t hi;
+
+    taskENTER_CRITICAL();
+    lo = logNext - logFill;
+    hi = logNext;
+
+    // Timestamps are sorted: binary search for the first one >= fromMs
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+
+        if (logRecords[mid % TEMP_LOG_DEPTH].timestampMs < fromMs) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return lo;
+}
+
+/*
+ *  ======== temp_log_read ========
+ */
+uint16_t temp_log_read(uint32_t *cursor, uint32_t toMs, TempLog_Record *out,
+                       uint16_t max, uint32_t *first)
+{
+    uint32_t index;
+    uint16_t n = 0;
+
+    taskENTER_CRITICAL();
+    index = *cursor;
+    if (logNext - index > logFill) {
+        index = logNext - logFill;
+    }
+    *first = index;
+
+    while (n < max && index != logNext) {
+        const TempLog_Record *rec = &logRecords[index % TEMP_LOG_DEPTH];
+
+        if (rec->timestampMs > toMs) {
+            break;
+        }
+        out[n++] = *rec;
+        index++;
+    }
+    taskEXIT_CRITICAL();
+
+    *cursor = index;
+    return n;
+}
@@ -0,0 +1,55 @@
+/*
+ *  ======== temp_log.h ========
+ *  In-RAM history of published temperatures for bulk download.
+ *
+ *  A ring of the last TEMP_LOG_DEPTH records, ordered by timestamp. Every
+ *  record gets an index counting from boot, so a reader that walks the
+ *  log with a cursor can tell when records it had not yet read were
+ *  overwritten. One task appends, any other task reads; both sides take a
+ *  short critical section.
+ */
+#ifndef TEMP_LOG_H_
+#define TEMP_LOG_H_
+
+#include <stdint.h>
+
+// Records kept, 12 bytes each
+#ifndef TEMP_LOG_DEPTH
+#define TEMP_LOG_DEPTH (256)
+#endif
+
+typedef struct
+{
+    uint32_t timestampMs;  // ms since boot
+    int32_t  tcCenti;      // thermocouple, centi-degrees C
+    int16_t  cjCenti;      // cold junction, centi-degrees C
+    uint8_t  channel;
+    uint8_t  fault;        // MAX31856 SR
+} TempLog_Record;
+
+/*
+ *  ======== temp_log_append ========
+ *  Store rec, overwriting the oldest record once the log is full.
+ *  Timestamps must not decrease.
+ */
+void temp_log_append(const TempLog_Record *rec);
+
+/*
+ *  ======== temp_log_find ========
+ *  Index of the oldest stored record with a timestamp of at least fromMs,
+ *  or the index the next appended record will get if there is none.
+ */
+uint32_t temp_log_find(uint32_t fromMs);
+
+/*
+ *  ======== temp_log_read ========
+ *  Copy up to max records, starting at index *cursor, into out and
+ *  advance *cursor past them. Records already overwritten are skipped;
+ *  *first gets the index of out[0], so first != the old *cursor means
+ *  records were lost. Stops before the first record newer than toMs.
+ *  Returns the number copied, 0 once the range is done.
+ */
+uint16_t temp_log_read(uint32_t *cursor, uint32_t toMs, TempLog_Record *out,
+                       uint16_t max, uint32_t *first);
+
+#endif /* TEMP_LOG_H_ */
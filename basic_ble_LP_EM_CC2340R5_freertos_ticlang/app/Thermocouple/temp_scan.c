@@ -0,0 +1,89 @@
+/*
+ *  ======== temp_scan.c ========
+ */
+#include <string.h>
+
+#include <ti/drivers/GPIO.h>
+
+#include "temp_scan.h"
+
+/*
+ *  ======== temp_scan_open ========
+ */
+bool temp_scan_open(TempScan *scan, SPI_Handle spi, const uint_least8_t *csGpios,
+                    uint8_t num, const Max31856_Config *cfg)
+{
+    Max31856_Config oneShot = *cfg;
+    TickType_t period;
+    uint8_t ch;
+
+    memset(scan, 0, sizeof(*scan));
+    scan->num = num > TEMP_SCAN_MAX_CHANNELS ? TEMP_SCAN_MAX_CHANNELS : num;
+    oneShot.cr0 &= ~MAX31856_CR0_CMODE;
+
+    // Every chip shares the bus: deselect all before talking to any
+    for (ch = 0; ch < scan->num; ch++) {
+        GPIO_setConfig(csGpios[ch], GPIO_CFG_OUT_STD | GPIO_CFG_OUT_HIGH);
+    }
+    for (ch = 0; ch < scan->num; ch++) {
+        if (max31856_open(&scan->dev[ch], spi, csGpios[ch], GPIO_INVALID_INDEX, &oneShot)) {
+            scan->present |= 1u << ch;
+        }
+    }
+
+    // A channel comes round once per cycle, which must cover a conversion
+    period = pdMS_TO_TICKS(max31856_conversion_ms(&oneShot)) + 1;
+    scan->slot = (period + scan->num - 1) / scan->num;
+    scan->wake = xTaskGetTickCount();
+
+    return scan->present != 0;
+}
+
+/*
+ *  ======== temp_scan_cycle ========
+ */
+bool temp_scan_cycle(TempScan *scan, TempScan_Vector *vec)
+{
+    uint8_t ch;
+
+    vec->num = scan->num;
+    vec->valid = 0;
+
+    for (ch = 0; ch < scan->num; ch++) {
+        Max31856_Device *dev = &scan->dev[ch];
+        uint8_t bit = 1u << ch;
+
+        vTaskDelayUntil(&scan->wake, scan->slot);
+
+        if (!(scan->present & bit)) {
+            if (!max31856_configure(dev)) {
+                continue;
+            }
+            scan->present |= bit;
+        }
+
+        // Result of the conversion started in this slot last cycle
+        if (scan->started & bit) {
+            if (max31856_read_sample(dev, &vec->sample[ch])) {
+                vec->valid |= bit;
+                dev->samples++;
+            }
+            else {
+                scan->errors++;
+            }
+        }
+
+        if (max31856_start_oneshot(dev)) {
+            scan->started |= bit;
+        }
+        else {
+            // Reconfigured before its next start
+            scan->errors++;
+            scan->started &= ~bit;
+            scan->present &= ~bit;
+        }
+    }
+
+    vec->cycle = scan->cycle++;
+    return vec->valid != 0;
+}
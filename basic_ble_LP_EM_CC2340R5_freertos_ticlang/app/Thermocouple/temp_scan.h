@@ -0,0 +1,60 @@
+/*
+ *  ======== temp_scan.h ========
+ *  Multi-channel thermocouple scanner: several MAX31856 on the SPI
+ *  controller, one chip select GPIO each.
+ *
+ *  The chips run one-shot conversions, so no DRDY lines are needed. A
+ *  scan cycle is one conversion time long and is split into one slot per
+ *  channel; in its slot a channel has its previous result read and its
+ *  next conversion started. The conversions overlap and the bus traffic
+ *  is spread evenly over the cycle instead of bunching up, and every cycle
+ *  yields a vector with one sample per channel.
+ */
+#ifndef TEMP_SCAN_H_
+#define TEMP_SCAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "max31856.h"
+
+#define TEMP_SCAN_MAX_CHANNELS (4)
+
+typedef struct
+{
+    uint32_t        cycle;
+    uint8_t         num;    // channels scanned
+    uint8_t         valid;  // bit n: sample[n] is a fresh result
+    Max31856_Sample sample[TEMP_SCAN_MAX_CHANNELS];
+} TempScan_Vector;
+
+typedef struct
+{
+    Max31856_Device dev[TEMP_SCAN_MAX_CHANNELS];
+    uint8_t    num;
+    uint8_t    present;  // bit n: channel n answered its configuration
+    uint8_t    started;  // bit n: channel n has a conversion running
+    TickType_t slot;     // ticks between consecutive channels
+    TickType_t wake;     // start of the next slot
+    uint32_t   cycle;
+    uint32_t   errors;   // failed reads and starts
+} TempScan;
+
+/*
+ *  ======== temp_scan_open ========
+ *  Configure num chips on spi, chip selects csGpios, all with cfg (CMODE
+ *  is dropped). Channels that do not answer are retried every cycle.
+ *  Returns false if none answered.
+ */
+bool temp_scan_open(TempScan *scan, SPI_Handle spi, const uint_least8_t *csGpios,
+                    uint8_t num, const Max31856_Config *cfg);
+
+/*
+ *  ======== temp_scan_cycle ========
+ *  Run one scan cycle, blocking for its duration, and fill *vec. Returns
+ *  true if any channel produced a sample; the first cycle only starts the
+ *  conversions.
+ */
+bool temp_scan_cycle(TempScan *scan, TempScan_Vector *vec);
+
+#endif /* TEMP_SCAN_H_ */
@@ -55,16 +55,50 @@ Target Device: cc23xx
 #include "ti_ble_config.h"
 #include "ti/ble/app_util/framework/bleapputil_api.h"
 #include "ti/ble/app_util/menu/menu_module.h"
+#include <ti/drivers/dpl/ClockP.h>
 #include <app_main.h>
 
+//*****************************************************************************
+//! Defines
+//*****************************************************************************
+
+// Connection parameters while streaming: interval in units of 1.25 ms,
+// supervision timeout in units of 10 ms
+#define CONN_STREAM_INTERVAL_MIN    6       // 7.5 ms
+#define CONN_STREAM_INTERVAL_MAX    12      // 15 ms
+#define CONN_STREAM_LATENCY         0
+#define CONN_STREAM_TIMEOUT         300     // 3 s
+
+// Connection parameters while idle. The timeout must exceed
+// (1 + latency) * interval * 2 = 8 s.
+#define CONN_IDLE_INTERVAL_MIN      400     // 500 ms
+#define CONN_IDLE_INTERVAL_MAX      800     // 1 s
+#define CONN_IDLE_LATENCY           3
+#define CONN_IDLE_TIMEOUT           1000    // 10 s
+
+// Time without demand before a connection goes idle. It also leaves the
+// peer time for service discovery after connecting.
+#define CONN_IDLE_DELAY_MS          5000
+
+// Refusals of a parameter set before the policy settles for the
+// parameters the central chose. Each retry waits for the idle delay.
+#define CONN_PARAMS_MAX_REFUSALS    3
+
 //*****************************************************************************
 //! Prototypes
 //*****************************************************************************
 void Connection_ConnEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData);
 void Connection_HciGAPEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData);
 
-static uint8_t Connection_addConnInfo(uint16_t connHandle, uint8_t *pAddr);
-static uint8_t Connection_removeConnInfo(uint16_t connHandle);
+static App_connInfo *Connection_addConnInfo(uint16_t connHandle, uint8_t *pAddr);
+static void Connection_removeConnInfo(uint16_t connHandle);
+static App_connInfo *Connection_findConnInfo(uint16_t connHandle);
+static void Connection_setTarget(App_connInfo *pConn, uint8_t target);
+static void Connection_applyParams(App_connInfo *pConn);
+static uint8_t Connection_paramsInUse(const App_connInfo *pConn);
+static void Connection_startIdleClock(void);
+static void Connection_idleClockCB(uintptr_t arg);
+static void Connection_idleTimeout(char *pData);
 
 //*****************************************************************************
 //! Globals
@@ -90,9 +124,15 @@ BLEAppUtil_EventHandler_t connectionHciGAPHandler =
                       BLEAPPUTIL_HCI_LE_EVENT_CODE
 };
 
-// Holds the connection handles
+// Holds the connected devices, one slot each. A connection lives in the
+// slot connHandle % MAX_NUM_BLE_CONNS, or the next free one after it, and
+// keeps its slot until it terminates. The controller hands out handles
+// 0..MAX_NUM_BLE_CONNS-1, so lookups hit on the first probe.
 static App_connInfo connectionConnList[MAX_NUM_BLE_CONNS];
 
+// Moves connections without demand to the idle parameters
+static ClockP_Struct connectionIdleClock;
+
 //*****************************************************************************
 //! Functions
 //*****************************************************************************
@@ -116,9 +156,19 @@ void Connection_ConnEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
         case BLEAPPUTIL_LINK_ESTABLISHED_EVENT:
         {
             gapEstLinkReqEvent_t *gapEstMsg = (gapEstLinkReqEvent_t *)pMsgData;
+            App_connInfo *pConn;
 
             // Add the connection to the connected device list
-            Connection_addConnInfo(gapEstMsg->connectionHandle, gapEstMsg->devAddr);
+            pConn = Connection_addConnInfo(gapEstMsg->connectionHandle, gapEstMsg->devAddr);
+            if (pConn != NULL)
+            {
+                pConn->connInterval = gapEstMsg->connInterval;
+                pConn->connLatency  = gapEstMsg->connLatency;
+                pConn->connTimeout  = gapEstMsg->connTimeout;
+            }
+
+            // Keep the central's parameters until the idle delay passes
+            Connection_startIdleClock();
 
             /*! Print the peer address and connection handle number */
             MenuModule_printf(APP_MENU_CONN_EVENT, 0, "Conn status: Established - "
@@ -158,10 +208,13 @@ void Connection_ConnEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
         case BLEAPPUTIL_LINK_PARAM_UPDATE_REQ_EVENT:
         {
             gapUpdateLinkParamReqEvent_t *pReq = (gapUpdateLinkParamReqEvent_t *)pMsgData;
+            App_connInfo *pConn = Connection_findConnInfo(pReq->req.connectionHandle);
 
-            // Only accept connection intervals with slave latency of 0
-            // This is just an example of how the application can send a response
-            if(pReq->req.connLatency == 0)
+            // While streaming only accept connection intervals with a
+            // peripheral latency of 0, which would otherwise delay the data
+            if(pReq->req.connLatency == 0 ||
+               pConn == NULL ||
+               pConn->demand == 0)
             {
                 BLEAppUtil_paramUpdateRsp(pReq,TRUE);
             }
@@ -176,6 +229,46 @@ void Connection_ConnEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
         case BLEAPPUTIL_LINK_PARAM_UPDATE_EVENT:
         {
             gapLinkUpdateEvent_t *pPkt = (gapLinkUpdateEvent_t *)pMsgData;
+            App_connInfo *pConn = Connection_findConnInfo(pPkt->connectionHandle);
+
+            if (pConn != NULL)
+            {
+                if (pPkt->status == SUCCESS)
+                {
+                    pConn->connInterval = pPkt->connInterval;
+                    pConn->connLatency  = pPkt->connLatency;
+                    pConn->connTimeout  = pPkt->connTimeout;
+                    pConn->paramUpdates++;
+                    pConn->paramsRefused = 0;
+                }
+
+                pConn->paramsPending = FALSE;
+
+                if (pPkt->status != SUCCESS &&
+                    pConn->params == pConn->paramsTarget)
+                {
+                    // The central refused the set and the link kept what it
+                    // was using. Retry after the idle delay rather than at
+                    // once, and after too many refusals settle for it.
+                    pConn->params = Connection_paramsInUse(pConn);
+                    if (++pConn->paramsRefused < CONN_PARAMS_MAX_REFUSALS)
+                    {
+                        Connection_startIdleClock();
+                    }
+                }
+                else
+                {
+                    if (pPkt->status != SUCCESS)
+                    {
+                        // An older set was refused, the link kept its own
+                        pConn->params = Connection_paramsInUse(pConn);
+                    }
+
+                    // The update procedure is over: request what the
+                    // policy wants now, if it changed meanwhile
+                    Connection_applyParams(pConn);
+                }
+            }
 
             // Get the address from the connection handle
             linkDBInfo_t linkInfo;
@@ -267,6 +360,14 @@ void Connection_HciGAPEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
               }
               else
               {
+                  App_connInfo *pConn = Connection_findConnInfo(pPUC->connHandle);
+
+                  if (pConn != NULL)
+                  {
+                      pConn->txPhy = pPUC->txPhy;
+                      pConn->rxPhy = pPUC->rxPhy;
+                      pConn->phyUpdates++;
+                  }
 #if !defined(Display_DISABLE_ALL)
                   char * currPhy =
                           (pPUC->rxPhy == PHY_UPDATE_COMPLETE_EVENT_1M) ? "1 Mbps" :
@@ -290,79 +391,91 @@ void Connection_HciGAPEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
 }
 
 /*********************************************************************
- * @fn      Connection_addConnInfo
+ * @fn      Connection_findConnInfo
  *
- * @brief   Add a device to the connected device list
+ * @brief   Find a device in the connected device list by connHandle,
+ *          probing from its home slot.
  *
- * @return  index of the connected device list entry where the new connection
- *          info is put in.
- *          If there is no room, MAX_NUM_BLE_CONNS will be returned.
+ * @return  the entry, or NULL if connHandle is not connected
  */
-static uint8_t Connection_addConnInfo(uint16_t connHandle, uint8_t *pAddr)
+static App_connInfo *Connection_findConnInfo(uint16_t connHandle)
 {
-  uint8_t i = 0;
+  uint8_t slot = connHandle % MAX_NUM_BLE_CONNS;
+  uint8_t i;
+
+  if (connHandle == LINKDB_CONNHANDLE_INVALID)
+  {
+    return NULL;
+  }
 
+  // Entries never move, so a miss has to look at every slot
   for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
   {
-    if (connectionConnList[i].connHandle == LINKDB_CONNHANDLE_INVALID)
+    if (connectionConnList[slot].connHandle == connHandle)
     {
-      // Found available entry to put a new connection info in
-      connectionConnList[i].connHandle = connHandle;
-      memcpy(connectionConnList[i].peerAddress, pAddr, B_ADDR_LEN);
-
-      break;
+      return &connectionConnList[slot];
     }
+    slot = (slot + 1) % MAX_NUM_BLE_CONNS;
   }
 
-  return i;
+  return NULL;
 }
 
 /*********************************************************************
- * @fn      Connection_removeConnInfo
+ * @fn      Connection_addConnInfo
  *
- * @brief   Remove a device from the connected device list
+ * @brief   Add a device to the connected device list, in its home slot
+ *          or the next free one after it
  *
- * @return  index of the connected device list entry where the new connection
- *          info is removed from.
- *          If connHandle is not found, MAX_NUM_BLE_CONNS will be returned.
+ * @return  the entry the new connection info is put in, or NULL if
+ *          there is no room.
  */
-static uint8_t Connection_removeConnInfo(uint16_t connHandle)
+static App_connInfo *Connection_addConnInfo(uint16_t connHandle, uint8_t *pAddr)
 {
-  uint8_t i = 0;
-  uint8_t index = 0;
-  uint8_t maxNumConn = MAX_NUM_BLE_CONNS;
+  uint8_t slot = connHandle % MAX_NUM_BLE_CONNS;
+  uint8_t i;
 
-  for (i = 0; i < maxNumConn; i++)
+  for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
   {
-    if (connectionConnList[i].connHandle == connHandle)
-    {
-      // Mark the entry as deleted
-      connectionConnList[i].connHandle = LINKDB_CONNHANDLE_INVALID;
+    App_connInfo *pConn = &connectionConnList[slot];
 
-      break;
+    if (pConn->connHandle == LINKDB_CONNHANDLE_INVALID)
+    {
+      // Found available entry to put a new connection info in
+      memset(pConn, 0, sizeof(App_connInfo));
+      pConn->connHandle    = connHandle;
+      memcpy(pConn->peerAddress, pAddr, B_ADDR_LEN);
+      pConn->params        = APP_CONN_PARAMS_DEFAULT;
+      pConn->paramsTarget  = APP_CONN_PARAMS_DEFAULT;
+      pConn->mtu           = ATT_MTU_SIZE;
+      pConn->txPhy         = PHY_UPDATE_COMPLETE_EVENT_1M;
+      pConn->rxPhy         = PHY_UPDATE_COMPLETE_EVENT_1M;
+
+      return pConn;
     }
+    slot = (slot + 1) % MAX_NUM_BLE_CONNS;
   }
 
-  // Save the index to return
-  index = i;
+  return NULL;
+}
+
+/*********************************************************************
+ * @fn      Connection_removeConnInfo
+ *
+ * @brief   Remove a device from the connected device list. The other
+ *          entries keep their slots.
+ *
+ * @return  none
+ */
+static void Connection_removeConnInfo(uint16_t connHandle)
+{
+  App_connInfo *pConn = Connection_findConnInfo(connHandle);
 
-  // Shift the items in the array
-  for(i = 0; i < maxNumConn - 1; i++)
+  if (pConn != NULL)
   {
-      if (connectionConnList[i].connHandle == LINKDB_CONNHANDLE_INVALID &&
-          connectionConnList[i + 1].connHandle == LINKDB_CONNHANDLE_INVALID)
-      {
-        break;
-      }
-      if (connectionConnList[i].connHandle == LINKDB_CONNHANDLE_INVALID &&
-          connectionConnList[i + 1].connHandle != LINKDB_CONNHANDLE_INVALID)
-      {
-        memmove(&connectionConnList[i], &connectionConnList[i+1], sizeof(App_connInfo));
-        connectionConnList[i + 1].connHandle = LINKDB_CONNHANDLE_INVALID;
-      }
+    // Mark the entry as deleted
+    pConn->connHandle = LINKDB_CONNHANDLE_INVALID;
   }
-
-  return index;
 }
 
 /*********************************************************************
@@ -370,7 +483,8 @@ static uint8_t Connection_removeConnInfo(uint16_t connHandle)
  *
  * @brief   Get the connection list
  *
- * @return  connection list
+ * @return  connection list, MAX_NUM_BLE_CONNS entries; free ones have
+ *          connHandle LINKDB_CONNHANDLE_INVALID
  */
 App_connInfo *Connection_getConnList(void)
 {
@@ -410,6 +524,7 @@ bStatus_t Connection_start()
 {
     bStatus_t status = SUCCESS;
     uint8 i;
+    ClockP_Params clockParams;
 
     // Initialize the connList handles
     for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
@@ -417,6 +532,12 @@ bStatus_t Connection_start()
         connectionConnList[i].connHandle = LINKDB_CONNHANDLE_INVALID;
     }
 
+    // One-shot, started whenever a connection may have become idle
+    ClockP_Params_init(&clockParams);
+    ClockP_construct(&connectionIdleClock, Connection_idleClockCB,
+                     (CONN_IDLE_DELAY_MS * 1000) / ClockP_getSystemTickPeriod(),
+                     &clockParams);
+
     status = BLEAppUtil_registerEventHandler(&connectionConnHandler);
     if(status != SUCCESS)
     {
@@ -437,22 +558,257 @@ bStatus_t Connection_start()
  *
  * @brief   Find index in the connected device list by connHandle
  *
- * @return  the index of the entry that has the given connection handle.
+ * @return  the index of the entry that has the given connection handle,
+ *          stable for the life of the connection.
  *          if there is no match, LL_INACTIVE_CONNECTIONS will be returned.
  */
 uint16_t Connection_getConnIndex(uint16_t connHandle)
+{
+  App_connInfo *pConn = Connection_findConnInfo(connHandle);
+
+  if (pConn == NULL)
+  {
+    return LL_INACTIVE_CONNECTIONS;
+  }
+  return pConn - connectionConnList;
+}
+
+/*********************************************************************
+ * @fn      Connection_getConnInfo
+ */
+App_connInfo *Connection_getConnInfo(uint16_t connHandle)
+{
+  return Connection_findConnInfo(connHandle);
+}
+
+/*********************************************************************
+ * @fn      Connection_setDemand
+ */
+void Connection_setDemand(uint16_t connHandle, uint8_t demand, uint8_t active)
+{
+  App_connInfo *pConn = Connection_findConnInfo(connHandle);
+
+  if (pConn == NULL)
+  {
+    return;
+  }
+
+  if (active)
+  {
+    pConn->demand |= demand;
+  }
+  else
+  {
+    pConn->demand &= ~demand;
+  }
+
+  if (pConn->demand != 0)
+  {
+    // Throughput is needed now
+    Connection_setTarget(pConn, APP_CONN_PARAMS_STREAM);
+  }
+  else
+  {
+    // Go idle unless demand returns before the delay passes
+    Connection_startIdleClock();
+  }
+}
+
+/*********************************************************************
+ * @fn      Connection_setMtu
+ */
+void Connection_setMtu(uint16_t connHandle, uint16_t mtu)
+{
+  App_connInfo *pConn = Connection_findConnInfo(connHandle);
+
+  if (pConn != NULL)
+  {
+    pConn->mtu = mtu;
+  }
+}
+
+/*********************************************************************
+ * @fn      Connection_getMtu
+ */
+uint16_t Connection_getMtu(uint16_t connHandle)
+{
+  App_connInfo *pConn = Connection_findConnInfo(connHandle);
+
+  return (pConn != NULL) ? pConn->mtu : ATT_MTU_SIZE;
+}
+
+/*********************************************************************
+ * @fn      Connection_setTarget
+ *
+ * @brief   Make target the parameter set the policy wants for the
+ *          connection and request it. A new target is given a fresh
+ *          count of refusals.
+ *
+ * @param   pConn - the connection
+ * @param   target - App_connParams
+ *
+ * @return  none
+ */
+static void Connection_setTarget(App_connInfo *pConn, uint8_t target)
+{
+  if (pConn->paramsTarget != target)
+  {
+    pConn->paramsTarget  = target;
+    pConn->paramsRefused = 0;
+  }
+  Connection_applyParams(pConn);
+}
+
+/*********************************************************************
+ * @fn      Connection_paramsInUse
+ *
+ * @brief   Find the parameter set the link's current interval and
+ *          latency fall in.
+ *
+ * @param   pConn - the connection
+ *
+ * @return  App_connParams, APP_CONN_PARAMS_DEFAULT if neither set
+ */
+static uint8_t Connection_paramsInUse(const App_connInfo *pConn)
+{
+  if (pConn->connInterval >= CONN_STREAM_INTERVAL_MIN &&
+      pConn->connInterval <= CONN_STREAM_INTERVAL_MAX &&
+      pConn->connLatency == CONN_STREAM_LATENCY)
+  {
+    return APP_CONN_PARAMS_STREAM;
+  }
+  if (pConn->connInterval >= CONN_IDLE_INTERVAL_MIN &&
+      pConn->connInterval <= CONN_IDLE_INTERVAL_MAX &&
+      pConn->connLatency == CONN_IDLE_LATENCY)
+  {
+    return APP_CONN_PARAMS_IDLE;
+  }
+  return APP_CONN_PARAMS_DEFAULT;
+}
+
+/*********************************************************************
+ * @fn      Connection_applyParams
+ *
+ * @brief   Request the connection parameters and PHY of the parameter
+ *          set the policy wants for the connection, unless they were
+ *          requested already or an update is still in progress.
+ *
+ * @param   pConn - the connection
+ *
+ * @return  none
+ */
+static void Connection_applyParams(App_connInfo *pConn)
+{
+  bStatus_t status;
+  gapUpdateLinkParamReq_t paramReq;
+  BLEAppUtil_ConnPhyParams_t phyParams;
+
+  if (pConn->paramsPending ||
+      pConn->params == pConn->paramsTarget ||
+      pConn->paramsTarget == APP_CONN_PARAMS_DEFAULT ||
+      pConn->paramsRefused >= CONN_PARAMS_MAX_REFUSALS)
+  {
+    return;
+  }
+
+  paramReq.connectionHandle = pConn->connHandle;
+  phyParams.connHandle      = pConn->connHandle;
+  phyParams.allPhys         = 0;
+  phyParams.phyOpts         = 0;
+
+  if (pConn->paramsTarget == APP_CONN_PARAMS_STREAM)
+  {
+    paramReq.intervalMin = CONN_STREAM_INTERVAL_MIN;
+    paramReq.intervalMax = CONN_STREAM_INTERVAL_MAX;
+    paramReq.connLatency = CONN_STREAM_LATENCY;
+    paramReq.connTimeout = CONN_STREAM_TIMEOUT;
+    phyParams.txPhy      = HCI_PHY_2_MBPS;
+    phyParams.rxPhy      = HCI_PHY_2_MBPS;
+  }
+  else
+  {
+    // 1M tolerates more path loss, which matters more than airtime when
+    // every missed event costs a second
+    paramReq.intervalMin = CONN_IDLE_INTERVAL_MIN;
+    paramReq.intervalMax = CONN_IDLE_INTERVAL_MAX;
+    paramReq.connLatency = CONN_IDLE_LATENCY;
+    paramReq.connTimeout = CONN_IDLE_TIMEOUT;
+    phyParams.txPhy      = HCI_PHY_1_MBPS;
+    phyParams.rxPhy      = HCI_PHY_1_MBPS;
+  }
+
+  status = BLEAppUtil_paramUpdateReq(&paramReq);
+  if (status == SUCCESS)
+  {
+    pConn->params        = pConn->paramsTarget;
+    pConn->paramsPending = TRUE;
+
+    // A peer without 2M support just stays on 1M
+    BLEAppUtil_setConnPhy(&phyParams);
+  }
+
+  MenuModule_printf(APP_MENU_CONN_EVENT, 0, "Conn status: Policy %s - "
+                    "connectionHandle = " MENU_MODULE_COLOR_YELLOW "%d " MENU_MODULE_COLOR_RESET
+                    "status = " MENU_MODULE_COLOR_YELLOW "%d" MENU_MODULE_COLOR_RESET,
+                    (pConn->paramsTarget == APP_CONN_PARAMS_STREAM) ? "stream" : "idle",
+                    pConn->connHandle, status);
+}
+
+/*********************************************************************
+ * @fn      Connection_startIdleClock
+ *
+ * @brief   (Re)start the idle delay.
+ *
+ * @return  none
+ */
+static void Connection_startIdleClock(void)
+{
+  ClockP_Handle hClock = ClockP_handle(&connectionIdleClock);
+
+  ClockP_stop(hClock);
+  ClockP_start(hClock);
+}
+
+/*********************************************************************
+ * @fn      Connection_idleClockCB
+ *
+ * @brief   Idle delay expired; continue in the BLE app task.
+ *
+ * @param   arg - unused
+ *
+ * @return  none
+ */
+static void Connection_idleClockCB(uintptr_t arg)
+{
+  BLEAppUtil_invokeFunction(Connection_idleTimeout, NULL);
+}
+
+/*********************************************************************
+ * @fn      Connection_idleTimeout
+ *
+ * @brief   Move every connection that has no demand to the idle
+ *          parameters, and request again a set the central refused.
+ *
+ * @param   pData - unused
+ *
+ * @return  none
+ */
+static void Connection_idleTimeout(char *pData)
 {
   uint8_t i;
 
   for (i = 0; i < MAX_NUM_BLE_CONNS; i++)
   {
-    if (connectionConnList[i].connHandle == connHandle)
+    if (connectionConnList[i].connHandle != LINKDB_CONNHANDLE_INVALID &&
+        connectionConnList[i].demand == 0)
+    {
+      Connection_setTarget(&connectionConnList[i], APP_CONN_PARAMS_IDLE);
+    }
+    else if (connectionConnList[i].connHandle != LINKDB_CONNHANDLE_INVALID)
     {
-      return i;
+      Connection_applyParams(&connectionConnList[i]);
     }
   }
-
-  return LL_INACTIVE_CONNECTIONS;
 }
 
 #endif // ( HOST_CONFIG & (CENTRAL_CFG | PERIPHERAL_CFG) )
@@ -48,6 +48,7 @@ Target Device: cc23xx
 //! Includes
 //*****************************************************************************
 #include <string.h>
+#include "ti_ble_config.h"
 #include "ti/ble/app_util/framework/bleapputil_api.h"
 #include "ti/ble/app_util/menu/menu_module.h"
 #include <app_main.h>
@@ -56,11 +57,21 @@ Target Device: cc23xx
 //! Defines
 //*****************************************************************************
 
+// Largest LL data PDU payload and the time it takes on the 1M PHY, so a
+// 247-byte ATT MTU plus the L2CAP header fits one PDU
+#define DATA_LE_TX_OCTETS   251
+#define DATA_LE_TX_TIME     2120
+
+// ATT MTU requested on connect: the largest the stack takes, 251 with the
+// 255-byte maximum PDU size set in basic_ble.syscfg
+#define DATA_ATT_MTU        (MAX_PDU_SIZE - L2CAP_HDR_SIZE)
+
 //*****************************************************************************
 //! Globals
 //*****************************************************************************
 
 static void GATT_EventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData);
+static void Data_ConnEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData);
 
 // Events handlers struct, contains the handlers and event masks
 // of the application data module
@@ -72,6 +83,15 @@ BLEAppUtil_EventHandler_t dataGATTHandler =
                       BLEAPPUTIL_ATT_MTU_UPDATED_EVENT
 };
 
+// Events handlers struct, contains the handlers and event masks
+// of the GAP connection notifications
+BLEAppUtil_EventHandler_t dataConnHandler =
+{
+    .handlerType    = BLEAPPUTIL_GAP_CONN_TYPE,
+    .pEventHandler  = Data_ConnEventHandler,
+    .eventMask      = BLEAPPUTIL_LINK_ESTABLISHED_EVENT
+};
+
 //*****************************************************************************
 //! Functions
 //*****************************************************************************
@@ -103,6 +123,9 @@ static void GATT_EventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
       {
           MenuModule_printf(APP_MENU_PROFILE_STATUS_LINE, 0, "GATT status: ATT MTU update to %d",
                             gattMsg->msg.mtuEvt.MTU);
+
+          // Notifications to this connection may now carry more
+          Connection_setMtu(gattMsg->connHandle, gattMsg->msg.mtuEvt.MTU);
       }
       break;
 
@@ -112,6 +135,48 @@ static void GATT_EventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
   }
 }
 
+/*********************************************************************
+ * @fn      Data_ConnEventHandler
+ *
+ * @brief   The purpose of this function is to handle connection related
+ *          events that rise from the GAP and were registered in
+ *          @ref BLEAppUtil_registerEventHandler
+ *
+ * @param   event - message event.
+ * @param   pMsgData - pointer to message data.
+ *
+ * @return  none
+ */
+static void Data_ConnEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
+{
+  switch (event)
+  {
+    case BLEAPPUTIL_LINK_ESTABLISHED_EVENT:
+      {
+          uint16_t connHandle = ((gapEstLinkReqEvent_t *)pMsgData)->connectionHandle;
+          attExchangeMTUReq_t mtuReq;
+          bStatus_t status;
+
+          // Ask for the longest LL PDUs, in case the peer did not
+          HCI_LE_SetDataLenCmd(connHandle, DATA_LE_TX_OCTETS, DATA_LE_TX_TIME);
+
+          // Negotiate the ATT MTU; the result arrives as
+          // ATT_MTU_UPDATED_EVENT. A peer that exchanges first wins.
+          mtuReq.clientRxMTU = DATA_ATT_MTU;
+          status = GATT_ExchangeMTU(connHandle, &mtuReq, BLEAppUtil_getSelfEntity());
+          if (status != SUCCESS)
+          {
+              MenuModule_printf(APP_MENU_PROFILE_STATUS_LINE, 0, "GATT status: MTU exchange failed %d",
+                                status);
+          }
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
 /*********************************************************************
  * @fn      Data_start
  *
@@ -128,6 +193,19 @@ bStatus_t Data_start( void )
 
   // Register the handlers
   status = BLEAppUtil_registerEventHandler( &dataGATTHandler );
+  if ( status != SUCCESS )
+  {
+    return( status );
+  }
+
+  status = BLEAppUtil_registerEventHandler( &dataConnHandler );
+  if ( status != SUCCESS )
+  {
+    return( status );
+  }
+
+  // New connections negotiate the longest LL PDUs from the start
+  HCI_LE_WriteSuggestedDefaultDataLenCmd( DATA_LE_TX_OCTETS, DATA_LE_TX_TIME );
 
   // Return status value
   return( status );
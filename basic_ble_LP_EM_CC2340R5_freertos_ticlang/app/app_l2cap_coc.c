@@ -133,6 +133,7 @@ According to the User Guide
 #if defined (BLE_V41_FEATURES) && (BLE_V41_FEATURES & L2CAP_COC_CFG)
 
 #include "ti/ble/host/l2cap/l2cap.h"
+#include "ti/ble/stack_util/osal/osal_bufmgr.h"
 #include <string.h>
 #include "ti/ble/stack_util/icall/app/icall.h"
 #include <ti/drivers/GPIO.h>
@@ -141,6 +142,8 @@ According to the User Guide
 #include "ti/ble/app_util/menu/menu_module.h"
 #include <app_main.h>
 #include "ti_drivers_config.h"
+#include <ti/drivers/dpl/ClockP.h>
+#include "Thermocouple/temp_log.h"
 
 /*********************************************************************
  * MACROS
@@ -149,6 +152,46 @@ According to the User Guide
 /*********************************************************************
  * CONSTANTS
  */
+
+/*
+ * Log download protocol. The host sends one request SDU and the node
+ * answers with as many LOG_DATA SDUs as the range needs, each as large as
+ * the peer MTU allows, followed by one LOG_END. All fields little-endian.
+ *
+ *   LOG_READ  0x01  from u32, to u32     ms since boot, both inclusive
+ *   LOG_DATA  0x81  index u32, records   index of the first record
+ *   LOG_END   0x82  count u32, status u8 records sent
+ *
+ * A record is timestamp u32 ms, channel u8, thermocouple i32 and cold
+ * junction i16 in centi-degrees C, MAX31856 fault status u8: the
+ * temperature service stream record without its sequence number. Record
+ * indexes count from boot, so a jump between SDUs shows where records
+ * were overwritten before they could be sent.
+ */
+#define L2CAPCOC_LOG_READ             0x01
+#define L2CAPCOC_LOG_DATA             0x81
+#define L2CAPCOC_LOG_END              0x82
+
+#define L2CAPCOC_LOG_READ_LEN         9
+#define L2CAPCOC_LOG_DATA_HDR_LEN     5
+#define L2CAPCOC_LOG_END_LEN          6
+#define L2CAPCOC_LOG_REC_LEN          12
+
+// LOG_END status
+#define L2CAPCOC_LOG_OK               0x00  //!< Whole range sent
+#define L2CAPCOC_LOG_LOST             0x01  //!< Part of the range was overwritten first
+#define L2CAPCOC_LOG_BAD_REQ          0x02  //!< Request not understood, nothing sent
+
+// Most records one LOG_DATA SDU can carry
+#define L2CAPCOC_LOG_MAX_RECS         ((L2CAP_MAX_MTU - L2CAPCOC_LOG_DATA_HDR_LEN) / L2CAPCOC_LOG_REC_LEN)
+
+// SDUs built ahead of the stack. The stack sends one SDU per channel at a
+// time, so the queue keeps the next ones ready for when it is done.
+#define L2CAPCOC_TX_QUEUE_LEN         4
+
+// Throughput measurement window
+#define L2CAPCOC_TX_RATE_WINDOW_US    1000000
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -161,12 +204,48 @@ typedef struct
   uint16 PSM;          //!< PSM - Protocol/Service Multiplexer ID
   uint16 peerPSM;      //!< peer PSM - peer Protocol/Service Multiplexer ID
   uint8 taskId;        //!< Task registered with PSM
+  uint16 sduLen;       //!< Largest SDU this device sends, bounded by the peer MTU
 } gL2CAPCOC_AppData_t;
 
+/// @brief State of a log download.
+typedef struct
+{
+  uint32 cursor;       //!< Index of the next log record to send
+  uint32 toMs;         //!< End of the requested range, inclusive
+  uint32 sent;         //!< Records sent so far
+  uint8 status;        //!< Status the LOG_END will carry
+  uint8 active;        //!< Records are left to send
+} gL2CAPCOC_LogXfer_t;
+
+/// @brief An SDU waiting to be handed to the stack.
+typedef struct
+{
+  uint8 *pPayload;     //!< Allocated with L2CAP_bm_alloc, owned by the queue
+  uint16 len;          //!< Payload length
+} gL2CAPCOC_TxSdu_t;
+
+/// @brief Sender queue of the channel.
+typedef struct
+{
+  gL2CAPCOC_TxSdu_t sdu[L2CAPCOC_TX_QUEUE_LEN];
+  uint8 head;          //!< Oldest queued SDU
+  uint8 count;         //!< SDUs queued
+  uint8 inFlight;      //!< The stack accepted an SDU and has not reported it done
+  uint8 outOfCredit;   //!< The peer ran out of credits, wait for it to return some
+  uint32 rateStart;    //!< Start of the throughput window, in system ticks
+  uint32 rateBytes;    //!< Bytes sent in the throughput window
+  App_cocTxStats stats;
+} gL2CAPCOC_TxQueue_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
 gL2CAPCOC_AppData_t gL2CAPCOC_AppData;
+gL2CAPCOC_LogXfer_t gL2CAPCOC_LogXfer;
+gL2CAPCOC_TxQueue_t gL2CAPCOC_TxQueue;
+
+// Records of the LOG_DATA SDU being built, only used in the BLE app task
+static TempLog_Record logBatch[L2CAPCOC_LOG_MAX_RECS];
 
 /*********************************************************************
  * EXTERNAL VARIABLES
@@ -181,6 +260,13 @@ void L2CAPCOC_connEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData);
 
 static bStatus_t L2CAPCOC_openCoc(uint16_t connHandle);
 static bStatus_t L2CAPCOC_closeCoc(uint16_t connHandle);
+static void L2CAPCOC_txEnqueue(uint8_t *pPayload, uint16_t len);
+static void L2CAPCOC_txPump(void);
+static void L2CAPCOC_txDone(uint16_t txLen);
+static void L2CAPCOC_txDrop(void);
+static void L2CAPCOC_txFlush(void);
+static void L2CAPCOC_logRequest(const uint8_t *pReq, uint16_t len);
+static void L2CAPCOC_logFill(void);
 
 // Events handlers struct, contains the handlers and event masks
 // of the L2CAP data packets
@@ -200,7 +286,9 @@ BLEAppUtil_EventHandler_t DSL2CAPsignalHandler =
     .eventMask      = BLEAPPUTIL_L2CAP_CHANNEL_ESTABLISHED_EVT       |
                       BLEAPPUTIL_L2CAP_CHANNEL_TERMINATED_EVT        |
                       BLEAPPUTIL_L2CAP_OUT_OF_CREDIT_EVT             |
-                      BLEAPPUTIL_L2CAP_PEER_CREDIT_THRESHOLD_EVT
+                      BLEAPPUTIL_L2CAP_PEER_CREDIT_THRESHOLD_EVT     |
+                      BLEAPPUTIL_L2CAP_SEND_SDU_DONE_EVT             |
+                      BLEAPPUTIL_L2CAP_NUM_CTRL_DATA_PKT_EVT
 };
 
 // Events handlers struct, contains the handlers and event masks
@@ -304,7 +392,8 @@ void L2CAPCOC_connEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
 /*********************************************************************
  * @fn      L2CAPCOC_dataHandler
  *
- * @brief   Handles the data received on the L2CAP channel
+ * @brief   Handles the data received on the L2CAP channel: log download
+ *          requests.
  *
  * @param   event - event to handle
  * @param   pMsgData - data to handle
@@ -313,8 +402,6 @@ void L2CAPCOC_connEventHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
  */
 void L2CAPCOC_dataHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
 {
-  uint16 i = 0;
-
   if (!pMsgData)
   {
     // Caller needs to figure out by himself that pMsg is NULL
@@ -335,33 +422,14 @@ void L2CAPCOC_dataHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
                     pDataPkt->pkt.connHandle,
                     pDataPkt->pkt.CID,
                     pDataPkt->pkt.len);
-//  MenuModule_printf(APP_MENU_PROFILE_STATUS_LINE3, 0,
-//                    "Incoming Data: " MENU_MODULE_COLOR_YELLOW "%s" MENU_MODULE_COLOR_RESET,
-//                    pDataPkt->pkt.pPayload);
 
-  // Change upper case to lower case and vice versa
-  for ( i = 0; i < pDataPkt->pkt.len; i++ )
+  if (pDataPkt->pkt.CID == gL2CAPCOC_AppData.CID)
   {
-    if ( pDataPkt->pkt.pPayload[i] >= 'a' && pDataPkt->pkt.pPayload[i] <= 'z' )
-    {
-      pDataPkt->pkt.pPayload[i] = pDataPkt->pkt.pPayload[i] - 32;
-    }
-    else if ( pDataPkt->pkt.pPayload[i] >= 'A' && pDataPkt->pkt.pPayload[i] <= 'Z' )
-    {
-      pDataPkt->pkt.pPayload[i] = pDataPkt->pkt.pPayload[i] + 32;
-    }
+    L2CAPCOC_logRequest(pDataPkt->pkt.pPayload, pDataPkt->pkt.len);
   }
 
-//  MenuModule_printf(APP_MENU_PROFILE_STATUS_LINE4, 0,
-//                    "Outgoing Data: " MENU_MODULE_COLOR_YELLOW "%s" MENU_MODULE_COLOR_RESET,
-//                    pDataPkt->pkt.pPayload);
-
-  // The app takes the received data, changes the payload according to ( Upper-Case <---->lower-case )
-  // and sends it back to the peer device (loopback implementation).
-  // It is possible to expand this function to support multiple COC CID's
-  pDataPkt->pkt.connHandle = gL2CAPCOC_AppData.connHandle;
-  pDataPkt->pkt.CID = gL2CAPCOC_AppData.CID;
-  L2CAP_SendSDU( &pDataPkt->pkt );
+  // The payload is not sent back, so it is ours to free
+  BM_free(pDataPkt->pkt.pPayload);
 }
 
 /*********************************************************************
@@ -390,6 +458,12 @@ void L2CAPCOC_signalHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
       l2capChannelEstEvt_t *pConnEvt = &((l2capSignalEvent_t *)pMsgData)->cmd.channelEstEvt;
       gL2CAPCOC_AppData.CID        = pConnEvt->CID;
       gL2CAPCOC_AppData.peerCID    = pConnEvt->info.peerCID;
+      gL2CAPCOC_AppData.sduLen     = pConnEvt->info.peerMtu < L2CAP_MAX_MTU ?
+                                     pConnEvt->info.peerMtu : L2CAP_MAX_MTU;
+      memset(&gL2CAPCOC_LogXfer, 0, sizeof(gL2CAPCOC_LogXfer));
+      L2CAPCOC_txFlush();
+      memset(&gL2CAPCOC_TxQueue.stats, 0, sizeof(gL2CAPCOC_TxQueue.stats));
+      gL2CAPCOC_TxQueue.rateStart = ClockP_getSystemTicks();
 
       MenuModule_printf(APP_MENU_PROFILE_STATUS_LINE1, 0,
                         "L2CAP: COC established "
@@ -405,28 +479,6 @@ void L2CAPCOC_signalHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
                         gL2CAPCOC_AppData.peerCID,
                         pConnEvt->info.mtu,
                         pConnEvt->info.mps);
-
-      /* Send the first packet to the peer device.
-       * This packet will be echoed and sent back and forward until the connection will be destroyed.*/
-      if (L2CAP_CONN_ESTABLISH_ROLE == L2CAPCOC_INITIATOR)
-      {
-          l2capPacket_t packet;
-          packet.connHandle = gL2CAPCOC_AppData.connHandle;
-          packet.CID = gL2CAPCOC_AppData.CID;
-          packet.len = L2CAP_MAX_MTU;
-          packet.pPayload = (uint8_t *)L2CAP_bm_alloc( L2CAP_MAX_MTU );
-
-          memset (packet.pPayload, 0x41 /*"A"*/, L2CAP_MAX_MTU);
-
-          bStatus_t  status = L2CAP_SendSDU( &packet );
-          MenuModule_printf(APP_MENU_PROFILE_STATUS_LINE2, 0,
-                            "L2CAP: Data Sent "
-                            "status "               MENU_MODULE_COLOR_YELLOW "%d " MENU_MODULE_COLOR_RESET
-                            "L2CAP_MAX_MTU "        MENU_MODULE_COLOR_YELLOW "%d " MENU_MODULE_COLOR_RESET,
-                            status,
-                            L2CAP_MAX_MTU);
-
-      }
       return;
     }
     case BLEAPPUTIL_L2CAP_PEER_CREDIT_THRESHOLD_EVT:
@@ -438,13 +490,65 @@ void L2CAPCOC_signalHandler(uint32 event, BLEAppUtil_msgHdr_t *pMsgData)
       L2CAP_FlowCtrlCredit(connHandle, pCreditEvt->CID, L2CAP_NOF_CREDITS);
       return;
     }
-    case BLEAPPUTIL_L2CAP_OUT_OF_CREDIT_EVT:
-      /* Do nothing */
-    case BLEAPPUTIL_L2CAP_CHANNEL_TERMINATED_EVT:
     case BLEAPPUTIL_L2CAP_SEND_SDU_DONE_EVT:
+    {
+      l2capSendSduDoneEvt_t *pDoneEvt = &((l2capSignalEvent_t *)pMsgData)->cmd.sendSduDoneEvt;
+
+      if (pDoneEvt->CID == gL2CAPCOC_AppData.CID)
+      {
+        // The stack could only finish the SDU because the peer returned
+        // credits, even if the last of them went into it. SendSDU tells
+        // whether the next one can go.
+        gL2CAPCOC_TxQueue.outOfCredit = FALSE;
+        L2CAPCOC_txDone(pDoneEvt->txLen);
+        L2CAPCOC_logFill();
+
+        if (gL2CAPCOC_TxQueue.count == 0 && gL2CAPCOC_TxQueue.inFlight == 0)
+        {
+          if (!gL2CAPCOC_LogXfer.active)
+          {
+            Connection_setDemand(gL2CAPCOC_AppData.connHandle, APP_CONN_DEMAND_BULK, FALSE);
+          }
+          MenuModule_printf(APP_MENU_PROFILE_STATUS_LINE4, 0,
+                            "L2CAP: sent "
+                            "bytes/s "  MENU_MODULE_COLOR_YELLOW "%d " MENU_MODULE_COLOR_RESET
+                            "stalls "   MENU_MODULE_COLOR_YELLOW "%d " MENU_MODULE_COLOR_RESET
+                            "retries "  MENU_MODULE_COLOR_YELLOW "%d " MENU_MODULE_COLOR_RESET,
+                            gL2CAPCOC_TxQueue.stats.bytesPerSec,
+                            gL2CAPCOC_TxQueue.stats.stalls,
+                            gL2CAPCOC_TxQueue.stats.retries);
+        }
+      }
+      return;
+    }
+    case BLEAPPUTIL_L2CAP_OUT_OF_CREDIT_EVT:
+    {
+      l2capCreditEvt_t *pCreditEvt = &((l2capSignalEvent_t *)pMsgData)->cmd.creditEvt;
+
+      // The stack holds the SDU it is sending until the peer returns
+      // credits; hand it no more until then
+      if (pCreditEvt->CID == gL2CAPCOC_AppData.CID && !gL2CAPCOC_TxQueue.outOfCredit)
+      {
+        gL2CAPCOC_TxQueue.outOfCredit = TRUE;
+        gL2CAPCOC_TxQueue.stats.stalls++;
+      }
+      return;
+    }
     case BLEAPPUTIL_L2CAP_NUM_CTRL_DATA_PKT_EVT:
-      /* No further actions required - we have handled the events. */
-      break;
+    {
+      // The controller freed buffers, retry an SDU the stack refused
+      L2CAPCOC_txPump();
+      return;
+    }
+    case BLEAPPUTIL_L2CAP_CHANNEL_TERMINATED_EVT:
+    {
+      // The link may stay up: let it go idle again if a download was
+      // cut off
+      Connection_setDemand(gL2CAPCOC_AppData.connHandle, APP_CONN_DEMAND_BULK, FALSE);
+      memset(&gL2CAPCOC_LogXfer, 0, sizeof(gL2CAPCOC_LogXfer));
+      L2CAPCOC_txFlush();
+      return;
+    }
     default:
       break;
   }
@@ -542,8 +646,319 @@ static bStatus_t L2CAPCOC_closeCoc(uint16_t connHandle)
                     gL2CAPCOC_AppData.PSM);
 
   memset(&gL2CAPCOC_AppData, 0, sizeof(gL2CAPCOC_AppData));
+  memset(&gL2CAPCOC_LogXfer, 0, sizeof(gL2CAPCOC_LogXfer));
+  L2CAPCOC_txFlush();
 
   return ret;
 }
 
+/*********************************************************************
+ * @fn      L2CAPCOC_getTxStats
+ */
+void L2CAPCOC_getTxStats(App_cocTxStats *pStats)
+{
+  *pStats = gL2CAPCOC_TxQueue.stats;
+}
+
+/*********************************************************************
+* @fn      L2CAPCOC_txEnqueue
+*
+* @brief   Queue an SDU for the channel and send it as soon as the stack
+*          and the peer credits allow. The caller checks for room first.
+*
+* @param   pPayload - payload allocated with L2CAP_bm_alloc, now owned
+*                     by the queue
+* @param   len - payload length
+*
+* @return  none
+*/
+static void L2CAPCOC_txEnqueue(uint8_t *pPayload, uint16_t len)
+{
+  gL2CAPCOC_TxQueue_t *pQueue = &gL2CAPCOC_TxQueue;
+  gL2CAPCOC_TxSdu_t *pSdu = &pQueue->sdu[(pQueue->head + pQueue->count) % L2CAPCOC_TX_QUEUE_LEN];
+
+  pSdu->pPayload = pPayload;
+  pSdu->len      = len;
+  pQueue->count++;
+
+  L2CAPCOC_txPump();
+}
+
+/*********************************************************************
+* @fn      L2CAPCOC_txPump
+*
+* @brief   Hand the oldest queued SDU to the stack once the previous one
+*          is done, unless the peer is out of credits. An SDU the stack
+*          has no room for stays queued and is retried on the next
+*          SEND_SDU_DONE or NUM_CTRL_DATA_PKT event.
+*
+* @return  none
+*/
+static void L2CAPCOC_txPump(void)
+{
+  gL2CAPCOC_TxQueue_t *pQueue = &gL2CAPCOC_TxQueue;
+
+  if (pQueue->count > 0 && !pQueue->inFlight && !pQueue->outOfCredit)
+  {
+    gL2CAPCOC_TxSdu_t *pSdu = &pQueue->sdu[pQueue->head];
+    l2capPacket_t packet;
+    bStatus_t status;
+
+    packet.connHandle = gL2CAPCOC_AppData.connHandle;
+    packet.CID        = gL2CAPCOC_AppData.CID;
+    packet.len        = pSdu->len;
+    packet.pPayload   = pSdu->pPayload;
+
+    status = L2CAP_SendSDU(&packet);
+    if (status == SUCCESS)
+    {
+      // The stack owns the payload now
+      pQueue->head = (pQueue->head + 1) % L2CAPCOC_TX_QUEUE_LEN;
+      pQueue->count--;
+      pQueue->inFlight = TRUE;
+    }
+    else if (status == blePending)
+    {
+      // The stack is still sending an SDU this app did not account for,
+      // its SEND_SDU_DONE pumps again. Not a retry.
+    }
+    else if (status == bleNoResources || status == bleMemAllocError ||
+             status == MSG_BUFFER_NOT_AVAIL)
+    {
+      // Stack or controller buffers are full
+      pQueue->stats.retries++;
+    }
+    else
+    {
+      // The SDU is invalid or the channel is going: nothing queued can go.
+      // Only the channel terminated event forgets an SDU the stack holds.
+      L2CAPCOC_txDrop();
+      gL2CAPCOC_LogXfer.active = FALSE;
+      Connection_setDemand(gL2CAPCOC_AppData.connHandle, APP_CONN_DEMAND_BULK, FALSE);
+    }
+  }
+}
+
+/*********************************************************************
+* @fn      L2CAPCOC_txDone
+*
+* @brief   Account for an SDU the stack finished sending and send the
+*          next queued one.
+*
+* @param   txLen - bytes of the SDU that were sent
+*
+* @return  none
+*/
+static void L2CAPCOC_txDone(uint16_t txLen)
+{
+  gL2CAPCOC_TxQueue_t *pQueue = &gL2CAPCOC_TxQueue;
+  uint32_t now = ClockP_getSystemTicks();
+  uint64_t elapsedUs;
+  uint8_t idle;
+
+  pQueue->inFlight = FALSE;
+  pQueue->stats.sdusSent++;
+  pQueue->stats.bytesSent += txLen;
+  pQueue->rateBytes       += txLen;
+
+  L2CAPCOC_txPump();
+  idle = (pQueue->count == 0 && pQueue->inFlight == 0);
+
+  // Refresh the rate once per window, and when a burst ends so short
+  // transfers get one too
+  elapsedUs = (uint64_t)(now - pQueue->rateStart) * ClockP_getSystemTickPeriod();
+  if (elapsedUs >= L2CAPCOC_TX_RATE_WINDOW_US || (idle && elapsedUs > 0))
+  {
+    pQueue->stats.bytesPerSec = (uint32_t)(((uint64_t)pQueue->rateBytes * 1000000) / elapsedUs);
+    pQueue->rateStart = now;
+    pQueue->rateBytes = 0;
+  }
+}
+
+/*********************************************************************
+* @fn      L2CAPCOC_txDrop
+*
+* @brief   Free every queued SDU. The one the stack holds, if any, is
+*          still in flight.
+*
+* @return  none
+*/
+static void L2CAPCOC_txDrop(void)
+{
+  gL2CAPCOC_TxQueue_t *pQueue = &gL2CAPCOC_TxQueue;
+
+  while (pQueue->count > 0)
+  {
+    BM_free(pQueue->sdu[pQueue->head].pPayload);
+    pQueue->head = (pQueue->head + 1) % L2CAPCOC_TX_QUEUE_LEN;
+    pQueue->count--;
+  }
+  pQueue->head = 0;
+}
+
+/*********************************************************************
+* @fn      L2CAPCOC_txFlush
+*
+* @brief   Free every queued SDU and forget the one with the stack, once
+*          the channel is gone or newly established. The counters are
+*          kept.
+*
+* @return  none
+*/
+static void L2CAPCOC_txFlush(void)
+{
+  gL2CAPCOC_TxQueue_t *pQueue = &gL2CAPCOC_TxQueue;
+
+  L2CAPCOC_txDrop();
+  pQueue->inFlight    = FALSE;
+  pQueue->outOfCredit = FALSE;
+}
+
+/*********************************************************************
+* @fn      L2CAPCOC_logRequest
+*
+* @brief   Start sending the log records of the requested time range,
+*          replacing any download in progress.
+*
+* @param   pReq - LOG_READ request
+* @param   len - request length
+*
+* @return  none
+*/
+static void L2CAPCOC_logRequest(const uint8_t *pReq, uint16_t len)
+{
+  gL2CAPCOC_LogXfer_t *pXfer = &gL2CAPCOC_LogXfer;
+
+  pXfer->sent   = 0;
+  pXfer->active = TRUE;
+  Connection_setDemand(gL2CAPCOC_AppData.connHandle, APP_CONN_DEMAND_BULK, TRUE);
+
+  // Measure the throughput of this download, not the idle time before it
+  if (gL2CAPCOC_TxQueue.count == 0 && gL2CAPCOC_TxQueue.inFlight == 0)
+  {
+    gL2CAPCOC_TxQueue.rateStart = ClockP_getSystemTicks();
+    gL2CAPCOC_TxQueue.rateBytes = 0;
+  }
+
+  if (len == L2CAPCOC_LOG_READ_LEN && pReq[0] == L2CAPCOC_LOG_READ)
+  {
+    pXfer->cursor = temp_log_find(BUILD_UINT32(pReq[1], pReq[2], pReq[3], pReq[4]));
+    pXfer->toMs   = BUILD_UINT32(pReq[5], pReq[6], pReq[7], pReq[8]);
+    pXfer->status = L2CAPCOC_LOG_OK;
+  }
+  else
+  {
+    // An empty range: only the LOG_END is sent
+    pXfer->cursor = temp_log_find(0xFFFFFFFF);
+    pXfer->toMs   = 0;
+    pXfer->status = L2CAPCOC_LOG_BAD_REQ;
+  }
+
+  MenuModule_printf(APP_MENU_PROFILE_STATUS_LINE3, 0,
+                    "L2CAP: log request status " MENU_MODULE_COLOR_YELLOW "%d " MENU_MODULE_COLOR_RESET
+                    "from record " MENU_MODULE_COLOR_YELLOW "%d " MENU_MODULE_COLOR_RESET,
+                    pXfer->status,
+                    pXfer->cursor);
+
+  L2CAPCOC_logFill();
+}
+
+/*********************************************************************
+* @fn      L2CAPCOC_logFill
+*
+* @brief   Build the next SDUs of the download, LOG_DATA until the range is
+*          done and then its LOG_END, while the sender queue has room.
+*          Called again whenever the stack finishes an SDU.
+*
+* @return  none
+*/
+static void L2CAPCOC_logFill(void)
+{
+  gL2CAPCOC_LogXfer_t *pXfer = &gL2CAPCOC_LogXfer;
+  uint16_t maxRecs;
+  uint16_t numRecs;
+  uint32_t first;
+  uint32_t cursor;
+  uint8_t *pPayload;
+  uint8_t *p;
+  uint16_t i;
+
+  maxRecs = (gL2CAPCOC_AppData.sduLen - L2CAPCOC_LOG_DATA_HDR_LEN) / L2CAPCOC_LOG_REC_LEN;
+  if (maxRecs > L2CAPCOC_LOG_MAX_RECS)
+  {
+    maxRecs = L2CAPCOC_LOG_MAX_RECS;
+  }
+
+  while (pXfer->active && gL2CAPCOC_TxQueue.count < L2CAPCOC_TX_QUEUE_LEN)
+  {
+    cursor = pXfer->cursor;
+    numRecs = temp_log_read(&cursor, pXfer->toMs, logBatch, maxRecs, &first);
+
+    pPayload = (uint8_t *)L2CAP_bm_alloc(numRecs == 0 ? L2CAPCOC_LOG_END_LEN :
+                                         L2CAPCOC_LOG_DATA_HDR_LEN +
+                                         numRecs * L2CAPCOC_LOG_REC_LEN);
+    if (pPayload == NULL)
+    {
+      // Try again when the SDU in flight is done, if there is one
+      if (gL2CAPCOC_TxQueue.count == 0 && gL2CAPCOC_TxQueue.inFlight == 0)
+      {
+        pXfer->active = FALSE;
+        Connection_setDemand(gL2CAPCOC_AppData.connHandle, APP_CONN_DEMAND_BULK, FALSE);
+      }
+      return;
+    }
+
+    if (numRecs == 0)
+    {
+      // Range done: LOG_END
+      pPayload[0] = L2CAPCOC_LOG_END;
+      pPayload[1] = BREAK_UINT32(pXfer->sent, 0);
+      pPayload[2] = BREAK_UINT32(pXfer->sent, 1);
+      pPayload[3] = BREAK_UINT32(pXfer->sent, 2);
+      pPayload[4] = BREAK_UINT32(pXfer->sent, 3);
+      pPayload[5] = pXfer->status;
+
+      pXfer->active = FALSE;
+      L2CAPCOC_txEnqueue(pPayload, L2CAPCOC_LOG_END_LEN);
+      return;
+    }
+
+    p = pPayload;
+    *p++ = L2CAPCOC_LOG_DATA;
+    *p++ = BREAK_UINT32(first, 0);
+    *p++ = BREAK_UINT32(first, 1);
+    *p++ = BREAK_UINT32(first, 2);
+    *p++ = BREAK_UINT32(first, 3);
+
+    for (i = 0; i < numRecs; i++)
+    {
+      const TempLog_Record *pRec = &logBatch[i];
+      uint32_t tc = (uint32_t)pRec->tcCenti;
+      uint16_t cj = (uint16_t)pRec->cjCenti;
+
+      *p++ = BREAK_UINT32(pRec->timestampMs, 0);
+      *p++ = BREAK_UINT32(pRec->timestampMs, 1);
+      *p++ = BREAK_UINT32(pRec->timestampMs, 2);
+      *p++ = BREAK_UINT32(pRec->timestampMs, 3);
+      *p++ = pRec->channel;
+      *p++ = BREAK_UINT32(tc, 0);
+      *p++ = BREAK_UINT32(tc, 1);
+      *p++ = BREAK_UINT32(tc, 2);
+      *p++ = BREAK_UINT32(tc, 3);
+      *p++ = LO_UINT16(cj);
+      *p++ = HI_UINT16(cj);
+      *p++ = pRec->fault;
+    }
+
+    if (first != pXfer->cursor)
+    {
+      pXfer->status = L2CAPCOC_LOG_LOST;
+    }
+    pXfer->cursor = cursor;
+    pXfer->sent  += numRecs;
+
+    L2CAPCOC_txEnqueue(pPayload, (uint16_t)(p - pPayload));
+  }
+}
+
 #endif //(BLE_V41_FEATURES) && (BLE_V41_FEATURES & L2CAP_COC_CFG)
@@ -3,6 +3,7 @@
 #include "ti/ble/app_util/framework/bleapputil_api.h"
 #include "ti/ble/app_util/menu/menu_module.h"
 #include <app_main.h>
+#include "Profiles/temp_service.h"
 #include <ti/drivers/GPIO.h>
 #include <ti/drivers/Board.h>
 #include "ti_drivers_config.h"
@@ -107,6 +108,11 @@ void App_StackInitDoneHandler(gapDeviceInitDoneEvent_t *deviceInitDoneData)
     {
         // TODO: Call Error Handler
     }
+    status = TempService_start();
+    if(status != SUCCESS)
+    {
+        // TODO: Call Error Handler
+    }
 #endif
 
 #if defined( HOST_CONFIG ) && ( HOST_CONFIG & ( PERIPHERAL_CFG | CENTRAL_CFG ))  &&  defined(OAD_CFG)
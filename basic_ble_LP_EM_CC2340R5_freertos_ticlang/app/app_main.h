@@ -54,6 +54,10 @@ Target Device: cc23xx
 //! Defines
 //*****************************************************************************
 
+// Users of a connection that need throughput, see Connection_setDemand
+#define APP_CONN_DEMAND_STREAM      0x01    // Temperature notifications enabled
+#define APP_CONN_DEMAND_BULK        0x02    // L2CAP log download running
+
 //*****************************************************************************
 //! Typedefs
 //*****************************************************************************
@@ -74,6 +78,14 @@ typedef enum
     APP_MENU_PROFILE_STATUS_LINE4
 } AppMenu_rows;
 
+// Connection parameter sets of the connection policy
+typedef enum
+{
+    APP_CONN_PARAMS_DEFAULT,        // As the central connected
+    APP_CONN_PARAMS_STREAM,         // Short interval, 2M PHY
+    APP_CONN_PARAMS_IDLE            // Long interval with peripheral latency
+} App_connParams;
+
 PACKED_ALIGNED_TYPEDEF_STRUCT
 {
   /// Type of TargetA address in the directed advertising PDU
@@ -88,8 +100,31 @@ PACKED_ALIGNED_TYPEDEF_STRUCT
   uint16_t  connHandle;             // Connection Handle
   BLEAppUtil_BDaddr peerAddress;    // The address of the peer device
   uint16_t   notifyCbCnt;           // Notify callback counter
+  uint8_t   demand;                 // APP_CONN_DEMAND_* users active
+  uint8_t   params;                 // App_connParams in use or being requested
+  uint8_t   paramsTarget;           // App_connParams the policy wants
+  uint8_t   paramsPending;          // A parameter update is in progress
+  uint8_t   paramsRefused;          // Times the central refused paramsTarget
+  uint16_t  mtu;                    // Negotiated ATT MTU
+  uint8_t   txPhy;                  // PHY_UPDATE_COMPLETE_EVENT_* in use
+  uint8_t   rxPhy;
+  uint16_t  connInterval;           // Units of 1.25 ms
+  uint16_t  connLatency;            // Connection events the peripheral may skip
+  uint16_t  connTimeout;            // Supervision timeout, units of 10 ms
+  uint16_t  paramUpdates;           // Completed connection parameter updates
+  uint16_t  phyUpdates;             // Completed PHY updates
 } App_connInfo;
 
+// L2CAP COC sender counters
+typedef struct
+{
+  uint32_t  bytesSent;              // SDU bytes the stack reported sent
+  uint32_t  sdusSent;               // SDUs the stack reported done
+  uint32_t  bytesPerSec;            // Throughput over the last second of sending
+  uint32_t  stalls;                 // Times the peer ran out of credits
+  uint32_t  retries;                // SDUs the stack had no room for, sent again later
+} App_cocTxStats;
+
 //*****************************************************************************
 //! Functions
 //*****************************************************************************
@@ -257,6 +292,18 @@ bStatus_t DataStream_start(void);
  */
 bStatus_t L2CAPCOC_start(void);
 
+/*********************************************************************
+ * @fn      L2CAPCOC_getTxStats
+ *
+ * @brief   Get the sender counters of the L2CAP COC, reset when a
+ *          channel is established.
+ *
+ * @param   pStats - filled with the counters
+ *
+ * @return  none
+ */
+void L2CAPCOC_getTxStats(App_cocTxStats *pStats);
+
 /*********************************************************************
  * @fn      CGM_start
  *
@@ -407,7 +454,8 @@ uint8 Scan_getScanResList(App_scanResults **scanRes);
  *
  * @brief   Get the connection list
  *
- * @return  connection list
+ * @return  connection list, MAX_NUM_BLE_CONNS entries; free ones have
+ *          connHandle LINKDB_CONNHANDLE_INVALID
  */
 App_connInfo *Connection_getConnList(void);
 
@@ -430,9 +478,65 @@ uint16_t Connection_getConnhandle(uint8_t index);
  *
  * @param   connHandle - the connection handle
  *
- * @return  the index of the entry that has the given connection handle.
+ * @return  the index of the entry that has the given connection handle,
+ *          stable for the life of the connection.
  *          if there is no match, LL_INACTIVE_CONNECTIONS will be returned.
  */
 uint16_t Connection_getConnIndex(uint16_t connHandle);
 
+/*********************************************************************
+ * @fn      Connection_getConnInfo
+ *
+ * @brief   Find the connected device list entry of connHandle, with its
+ *          MTU, PHY, connection parameters and counters. Usually a
+ *          single lookup.
+ *
+ * @param   connHandle - the connection handle
+ *
+ * @return  the entry, or NULL if there is no match
+ */
+App_connInfo *Connection_getConnInfo(uint16_t connHandle);
+
+/*********************************************************************
+ * @fn      Connection_setDemand
+ *
+ * @brief   Tell the connection policy that a user of the connection
+ *          started or stopped needing throughput. While any user does,
+ *          the connection runs with short intervals on the 2M PHY; once
+ *          none has for a while it falls back to long intervals with
+ *          peripheral latency. Must be called from the BLE app task.
+ *
+ * @param   connHandle - connection handle
+ * @param   demand - APP_CONN_DEMAND_* user
+ * @param   active - TRUE when the user starts, FALSE when it stops
+ *
+ * @return  none
+ */
+void Connection_setDemand(uint16_t connHandle, uint8_t demand, uint8_t active);
+
+/*********************************************************************
+ * @fn      Connection_setMtu
+ *
+ * @brief   Record the ATT MTU negotiated on a connection.
+ *
+ * @param   connHandle - connection handle
+ * @param   mtu - the new ATT MTU
+ *
+ * @return  none
+ */
+void Connection_setMtu(uint16_t connHandle, uint16_t mtu);
+
+/*********************************************************************
+ * @fn      Connection_getMtu
+ *
+ * @brief   Get the ATT MTU of a connection, which bounds the size of
+ *          notifications to it.
+ *
+ * @param   connHandle - connection handle
+ *
+ * @return  the negotiated ATT MTU, ATT_MTU_SIZE if none was or the
+ *          connection is unknown
+ */
+uint16_t Connection_getMtu(uint16_t connHandle);
+
 #endif /* APP_MAIN_H_ */
@@ -1,5 +1,6 @@
 
 #include <stdio.h>
+#include <string.h>
 #include <FreeRTOS.h>
 #include <stdint.h>
 #include <task.h>
@@ -31,6 +32,32 @@
 
 #include <ti/drivers/BatteryMonitor.h>
 
+#include "app/Thermocouple/max31856.h"
+#include "app/Thermocouple/temp_fixed.h"
+#include "app/Thermocouple/temp_filter.h"
+#include "app/Thermocouple/temp_scan.h"
+#include "app/Thermocouple/temp_log.h"
+#include "app/Profiles/temp_service.h"
+
+// Thermocouple channels: 1 reads the MAX31856 on CS2 paced by its DRDY;
+// 2..4 scan the chips on CS2..CS5 with staggered one-shot conversions
+#ifndef TC_SCAN_CHANNELS
+#define TC_SCAN_CHANNELS (1)
+#endif
+
+// Conversions the MAX31856 averages per result (AVGSEL)
+#define TC_CHIP_AVERAGING MAX31856_CR1_AVG_4
+
+// Firmware filter on the chip's results, and how many results make one
+// published sample
+#define TC_FILTER_KIND    TempFilter_MOVING_AVG
+#define TC_FILTER_WINDOW  (8)
+#define TC_FILTER_SHIFT   (3)
+#define TC_DECIMATION     (4)
+
+// Faults that make the thermocouple reading meaningless
+#define TC_FAULTS_INVALID (MAX31856_SR_OPEN | MAX31856_SR_OVUV)
+
 
 int16_t currentTemperature;
 
@@ -44,13 +71,12 @@ static Display_Handle display;
 extern void appMain(void);
 extern void AssertHandler(uint8 assertCause, uint8 assertSubcause);
 
-static bool max31856_read_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16_t len);
-static bool max31856_write_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16_t len);
-
 
 static void readBatteryVoltageUTF8(char *buffer, size_t bufferSize)
 {
+    static const char prefix[] = "🔋 ";
     uint16_t milliVolts;
+    uint8_t len;
 
     // Initialize driver (only once in your system)
     BatteryMonitor_init();
@@ -58,10 +84,16 @@ static void readBatteryVoltageUTF8(char *buffer, size_t bufferSize)
     // Get current voltage in millivolts
     milliVolts = BatteryMonitor_getVoltage();
 
-    float volts = milliVolts / 1000.0f;
+    if (bufferSize < sizeof(prefix) + TEMP_FIXED_TEXT_MAX + 2) {
+        buffer[0] = '\0';
+        return;
+    }
 
-    // Format string in UTF-8 with 2 decimal places
-    snprintf(buffer, bufferSize, "🔋 %.2f V", volts);
+    // Format string in UTF-8 with 2 decimal places, rounded to 10 mV
+    memcpy(buffer, prefix, sizeof(prefix) - 1);
+    len = temp_fixed_format((milliVolts + 5) / 10, buffer + sizeof(prefix) - 1,
+                            TEMP_FIXED_TEXT_MAX);
+    memcpy(buffer + sizeof(prefix) - 1 + len, " V", 3);
 }
 
 int main()
@@ -118,192 +150,215 @@ void ledTask1000ms(void *pvParameters)
     }
 }
 
-void temptask(void *pvParameters)
+/*
+ *  ======== publishThermocouple ========
+ *  Log a filtered thermocouple temperature, with the cold junction and
+ *  faults of the sample that completed it, for download over L2CAP, and
+ *  publish it to the temperature service. Channel 0, the readable
+ *  temperature, is always published and also updates the simple profile
+ *  text characteristics with the on-die temperature; the other channels
+ *  only while someone is subscribed.
+ */
+static void publishThermocouple(uint8_t channel, int32_t tempCenti, const Max31856_Sample *sample)
 {
-    Temperature_init();
-    SPI_Handle controllerSpi;
-    SPI_Params spiParams;
-
-    // Open SPI once
-    SPI_Params_init(&spiParams);
-    spiParams.dataSize = 8;
-    spiParams.frameFormat = SPI_POL0_PHA1;
-    spiParams.bitRate = 1000000;
-
-    controllerSpi = SPI_open(CONFIG_SPI_CONTROLLER, &spiParams);
-    if (controllerSpi == NULL) {
-        vTaskDelete(NULL); // kill this task
+    const TempLog_Record rec = {
+        .timestampMs = xTaskGetTickCount() * portTICK_PERIOD_MS,
+        .tcCenti     = tempCenti,
+        .cjCenti     = (int16_t)temp_fixed_from_q(sample->cjRaw, 6),
+        .channel     = channel,
+        .fault       = sample->fault,
+    };
+
+    temp_log_append(&rec);
+
+    if (channel == 0 || TempService_subscribed()) {
+        TempService_Sample streamSample = {
+            .timestampMs = rec.timestampMs,
+            .tcCenti     = rec.tcCenti,
+            .cjCenti     = rec.cjCenti,
+            .channel     = rec.channel,
+            .fault       = rec.fault,
+        };
+
+        TempService_publish(&streamSample);
+    }
+    if (channel != 0) {
+        return;
     }
 
-    
-
-    // Configure MAX31856 for K-type (do it once)
-
-    while (1)
-    {
-            uint8_t val;
-
-    // CR0 = 0x80 → Continuous conversion, comparator mode, 50Hz filter
-    val = 0x80;
-    max31856_write_reg(controllerSpi, 0x00, &val, 1);
-
-    // CR1 = 0x03 → K-type thermocouple
-    val = 0x03;
-    max31856_write_reg(controllerSpi, 0x01, &val, 1);
-
-
-        uint8_t regVal;
-        float tempC;
-        uint8_t tempRaw[3];
-
-        // Read CR0 just for debugging
-        if (max31856_read_reg(controllerSpi, 0x00, &regVal, 1)) {
-
-        }
-
-        // Read CJT (cold junction) registers
-        if (max31856_read_reg(controllerSpi, 0x0A, &regVal, 1)) {
-
-        }
-        if (max31856_read_reg(controllerSpi, 0x0B, &regVal, 1)) {
-
-        }
-
-        // Read thermocouple temperature (3 bytes, 24-bit signed)
-        if (max31856_read_reg(controllerSpi, 0x0C, tempRaw, 3)) {
-            int32_t raw = ((int32_t)tempRaw[0] << 16) |
-                          ((int32_t)tempRaw[1] << 8) |
-                          tempRaw[2];
-            raw >>= 5; // D23–D5 are valid
-
-            tempC = raw * 0.0078125f; // 1 LSB = 0.0078125 °C
-            float temperature = tempC;
-
-uint8_t charValue5[SIMPLEGATTPROFILE_CHAR5_LEN];
-
-// format into string (UTF-8 = ASCII here)
-snprintf((char *)charValue5, SIMPLEGATTPROFILE_CHAR5_LEN, "%.2f", temperature);
-
-// Update GATT characteristic
+    uint8_t charValue5[SIMPLEGATTPROFILE_CHAR5_LEN];
 
-// char voltageStr[64];  // UTF-8 string buffer
-// readBatteryVoltageUTF8(voltageStr, sizeof(voltageStr));
-// printf("%s\n", voltageStr);  // prints with UTF-8 battery emoji
+    // format into string (UTF-8 = ASCII here)
+    temp_fixed_format(tempCenti, (char *)charValue5, SIMPLEGATTPROFILE_CHAR5_LEN);
 
+    // Update GATT characteristic
 
-// SimpleGattProfile_setParameter(SIMPLEGATTPROFILE_CHAR5,
-//                                SIMPLEGATTPROFILE_CHAR5_LEN,
-//                                voltageStr);
-SimpleGattProfile_setParameter(SIMPLEGATTPROFILE_CHAR5,
-                               SIMPLEGATTPROFILE_CHAR5_LEN,
-                               charValue5);
+    // char voltageStr[64];  // UTF-8 string buffer
+    // readBatteryVoltageUTF8(voltageStr, sizeof(voltageStr));
+    // printf("%s\n", voltageStr);  // prints with UTF-8 battery emoji
 
-    Temperature_init();
+    // SimpleGattProfile_setParameter(SIMPLEGATTPROFILE_CHAR5,
+    //                                SIMPLEGATTPROFILE_CHAR5_LEN,
+    //                                voltageStr);
+    SimpleGattProfile_setParameter(SIMPLEGATTPROFILE_CHAR5,
+                                   SIMPLEGATTPROFILE_CHAR5_LEN,
+                                   charValue5);
 
-    float currentTemperature = Temperature_getTemperature();
+    // Whole degrees from the on-die sensor
+    int32_t currentTemperature = (int32_t)Temperature_getTemperature() * 100;
 
     uint8_t charValue6[SIMPLEGATTPROFILE_CHAR6_LEN];
 
     // format into string (UTF-8 = ASCII here)
-    snprintf((char *)charValue6, SIMPLEGATTPROFILE_CHAR6_LEN, "%.2f", currentTemperature);
+    temp_fixed_format(currentTemperature, (char *)charValue6, SIMPLEGATTPROFILE_CHAR6_LEN);
 
     // Update GATT characteristic
     SimpleGattProfile_setParameter(SIMPLEGATTPROFILE_CHAR6,
-                                SIMPLEGATTPROFILE_CHAR6_LEN,
-                                charValue6);
-
-
+                                   SIMPLEGATTPROFILE_CHAR6_LEN,
+                                   charValue6);
+}
 
-            // Scale and send over BLE
-            uint32_t scaledTemp = (uint32_t)(tempC * 100); // e.g. 450.22 → 45022
+#if TC_SCAN_CHANNELS > 1
+/*
+ *  ======== thermocoupleScanLoop ========
+ *  Scan the MAX31856 on CS2..CS5 with one-shot conversions, filter and
+ *  publish each channel. Never returns.
+ */
+static void thermocoupleScanLoop(SPI_Handle spi, const TempFilter_Config *filterCfg)
+{
+    static const uint_least8_t csGpios[TEMP_SCAN_MAX_CHANNELS] = {CS2, CS3, CS4, CS5};
+    static TempScan scan;
+    static TempFilter filters[TC_SCAN_CHANNELS];
+    uint8_t ch;
+
+    // CR0: one-shot, 60 Hz rejection; CR1: K-type, averaged
+    const Max31856_Config scanCfg = {
+        .cr0 = 0,
+        .cr1 = TC_CHIP_AVERAGING | MAX31856_TC_K,
+    };
+
+    // Retry until at least one chip answers; the rest are retried per cycle
+    while (!temp_scan_open(&scan, spi, csGpios, TC_SCAN_CHANNELS, &scanCfg)) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    for (ch = 0; ch < TC_SCAN_CHANNELS; ch++) {
+        temp_filter_init(&filters[ch], filterCfg);
+    }
 
-            // If you only want 2 chars (max 655.35 °C):
-            uint8_t lowByte  = scaledTemp & 0xFF;
-            uint8_t highByte = (scaledTemp >> 8) & 0xFF;
-            SimpleGattProfile_setParameter(SIMPLEGATTPROFILE_CHAR1, sizeof(uint8_t), &lowByte);
-            SimpleGattProfile_setParameter(SIMPLEGATTPROFILE_CHAR2, sizeof(uint8_t), &highByte);
+    while (1)
+    {
+        TempScan_Vector vec;
 
-            // If you want 3 chars (up to 167772.15 °C), uncomment:
-            /*
-            uint8_t byte1 = scaledTemp & 0xFF;
-            uint8_t byte2 = (scaledTemp >> 8) & 0xFF;
-            uint8_t byte3 = (scaledTemp >> 16) & 0xFF;
-            SimpleGattProfile_setParameter(SIMPLEGATTPROFILE_CHAR1, sizeof(uint8_t), &byte1);
-            SimpleGattProfile_setParameter(SIMPLEGATTPROFILE_CHAR2, sizeof(uint8_t), &byte2);
-            SimpleGattProfile_setParameter(SIMPLEGATTPROFILE_CHAR3, sizeof(uint8_t), &byte3);
-            */
+        if (!temp_scan_cycle(&scan, &vec)) {
+            continue;
+        }
 
+        for (ch = 0; ch < vec.num; ch++) {
+            const Max31856_Sample *sample = &vec.sample[ch];
+            char text[TEMP_FIXED_TEXT_MAX];
+            int32_t tempCenti;
 
+            if (!(vec.valid & (1u << ch))) {
+                continue;
+            }
+            if (sample->fault & TC_FAULTS_INVALID) {
+                temp_filter_reset(&filters[ch]);
+                continue;
+            }
+            if (!temp_filter_push(&filters[ch], temp_fixed_from_q(sample->tcRaw, 7), &tempCenti)) {
+                continue;
+            }
 
+            temp_fixed_format(tempCenti, text, sizeof(text));
+            Display_printf(display, 0, 0, "TC%u %s", ch, text);
+            publishThermocouple(ch, tempCenti, sample);
         }
-
-        // GPIO_toggle(CONFIG_GPIO_LED_RED);
-
-        vTaskDelay(pdMS_TO_TICKS(1000)); // Delay 1s
     }
-
-    // Never reached, but safe cleanup
-    SPI_close(controllerSpi);
 }
-
-
-
-static bool max31856_write_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16_t len)
+#else
+/*
+ *  ======== thermocoupleDrdyLoop ========
+ *  Read the MAX31856 on CS2 each time DRDY2 signals a conversion, filter
+ *  and publish. Never returns.
+ */
+static void thermocoupleDrdyLoop(SPI_Handle spi, const TempFilter_Config *filterCfg)
 {
-    SPI_Transaction trans;
-    uint8_t txBuf[1 + 8] = {0};
+    static Max31856_Device thermocouple;
+    static TempFilter thermocoupleFilter;
+    TickType_t drdyTimeout;
+
+    // CR0: continuous conversion, 60 Hz rejection; CR1: K-type, averaged
+    const Max31856_Config thermocoupleCfg = {
+        .cr0 = MAX31856_CR0_CMODE,
+        .cr1 = TC_CHIP_AVERAGING | MAX31856_TC_K,
+    };
+
+    // Configure MAX31856 once; retry until the chip answers
+    while (!max31856_open(&thermocouple, spi, CS2, DRDY2, &thermocoupleCfg)) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
 
-    if (len > 8) return false;
+    temp_filter_init(&thermocoupleFilter, filterCfg);
 
-    // MSB=1 → write
-    txBuf[0] = reg | 0x80;
-    for (int i = 0; i < len; i++) {
-        txBuf[1 + i] = buf[i];
-    }
+    // Twice the conversion time without DRDY means the chip lost its
+    // configuration
+    drdyTimeout = pdMS_TO_TICKS(2 * max31856_conversion_ms(&thermocoupleCfg));
 
-    memset(&trans, 0, sizeof(trans));
-    trans.count = 1 + len;
-    trans.txBuf = txBuf;
-    trans.rxBuf = NULL;
+    // DRDY paces the loop: one transaction per finished conversion, one
+    // publish per TC_DECIMATION conversions
+    while (1)
+    {
+        Max31856_Sample sample;
+        int32_t tempCenti;
 
-    GPIO_write(CS2, 0);
-    bool ok = SPI_transfer(spi, &trans);
-    GPIO_write(CS2, 1);
+        if (!max31856_wait(&thermocouple, drdyTimeout, &sample)) {
+            continue;
+        }
+        if (sample.fault & TC_FAULTS_INVALID) {
+            temp_filter_reset(&thermocoupleFilter);
+            continue;
+        }
 
-    return ok;
+        // 1 LSB = 0.0078125 °C
+        if (temp_filter_push(&thermocoupleFilter, temp_fixed_from_q(sample.tcRaw, 7), &tempCenti)) {
+            publishThermocouple(0, tempCenti, &sample);
+        }
+    }
 }
+#endif
 
-
-static bool max31856_read_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16_t len)
+void temptask(void *pvParameters)
 {
-    SPI_Transaction trans;
-    uint8_t txBuf[1 + 8] = {0};   // addr + up to 8 bytes
-    uint8_t rxBuf[1 + 8] = {0};
-
-    if (len > 8) return false;    // safety limit
-
-    // First byte = register address (MSB=0 → read)
-    txBuf[0] = reg & 0x7F;
+    Temperature_init();
+    SPI_Handle controllerSpi;
+    SPI_Params spiParams;
 
-    memset(&trans, 0, sizeof(trans));
-    trans.count = 1 + len;        // 1 addr + len data
-    trans.txBuf = txBuf;
-    trans.rxBuf = rxBuf;
+    const TempFilter_Config filterCfg = {
+        .kind       = TC_FILTER_KIND,
+        .window     = TC_FILTER_WINDOW,
+        .shift      = TC_FILTER_SHIFT,
+        .decimation = TC_DECIMATION,
+    };
 
-    // Assert CS
-    GPIO_write(CS2, 0);
+    // Open SPI once
+    SPI_Params_init(&spiParams);
+    spiParams.dataSize = 8;
+    spiParams.frameFormat = SPI_POL0_PHA1;
+    spiParams.bitRate = 1000000;
 
-    bool ok = SPI_transfer(spi, &trans);
+    controllerSpi = SPI_open(CONFIG_SPI_CONTROLLER, &spiParams);
+    if (controllerSpi == NULL) {
+        vTaskDelete(NULL); // kill this task
+    }
 
-    // Deassert CS
-    GPIO_write(CS2, 1);
+#if TC_SCAN_CHANNELS > 1
+    thermocoupleScanLoop(controllerSpi, &filterCfg);
+#else
+    thermocoupleDrdyLoop(controllerSpi, &filterCfg);
+#endif
 
-    if (ok) {
-        for (int i = 0; i < len; i++) {
-            buf[i] = rxBuf[1 + i];   // skip address byte
-        }
-    }
-    return ok;
+    // Never reached, but safe cleanup
+    SPI_close(controllerSpi);
 }
 
 //*****************************************************************************
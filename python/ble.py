@@ -1,25 +1,111 @@
+import argparse
 import asyncio
+import struct
+import time
 import matplotlib.pyplot as plt
 import matplotlib.dates as mdates
 from datetime import datetime
 from bleak import BleakClient, BleakScanner
 
 DEVICE_NAME = "Yantra Temp"
-SERVICE_UUID = "0000fff0-0000-1000-8000-00805f9b34fb"
+SERVICE_UUID = "0000ffe0-0000-1000-8000-00805f9b34fb"
 
-# Define characteristic UUIDs with labels
-CHAR_UUIDS = {
-    "CHAR1": "0000fff1-0000-1000-8000-00805f9b34fb",  # low byte
-    "CHAR2": "0000fff2-0000-1000-8000-00805f9b34fb",  # high byte (preferred)
-    "CHAR3": "0000fff3-0000-1000-8000-00805f9b34fb"   # high byte (fallback)
-}
+# Temperature service: samples are pushed on the stream in batches of up
+# to 17 records per notification, as many as the ATT MTU allows; the
+# temperature characteristic holds the latest reading
+STREAM_UUID = "0000ffe1-0000-1000-8000-00805f9b34fb"
+TEMP_UUID = "0000ffe2-0000-1000-8000-00805f9b34fb"
+
+# One stream record: seq u16, timestamp ms u32, channel u8, thermocouple
+# centi-degC i32, cold junction centi-degC i16, MAX31856 fault status u8
+STREAM_FORMAT = "<HIBihB"
+
+# thermocouple centi-degC i32, MAX31856 fault status u8,
+# cold junction centi-degC i16
+TEMP_FORMAT = "<iBh"
+
+# Redraw the graph at most this often (s), samples can arrive much faster
+PLOT_PERIOD = 1.0
 
 # Store data for plotting
 time_data = []
 temp_data = []
 
 
-async def main():
+def decode_stream(data):
+    """Unpack one stream notification, a batch of one or more records,
+    into a list of dicts."""
+    return [
+        {
+            "seq": seq,
+            "timestamp_ms": ts_ms,
+            "channel": channel,
+            "temperature": tc / 100.0,
+            "cold_junction": cj / 100.0,
+            "fault": fault,
+        }
+        for seq, ts_ms, channel, tc, cj, fault in struct.iter_unpack(STREAM_FORMAT, bytes(data))
+    ]
+
+
+def decode_temperature(data):
+    """Unpack one read of the temperature characteristic into a dict."""
+    tc, fault, cj = struct.unpack(TEMP_FORMAT, bytes(data))
+    return {
+        "temperature": tc / 100.0,
+        "cold_junction": cj / 100.0,
+        "fault": fault,
+    }
+
+
+def add_point(temperature, last_plot):
+    """Append to graph data and save the plot as an image at most every
+    PLOT_PERIOD seconds. Returns the time of the last save."""
+    time_data.append(datetime.now())
+    temp_data.append(temperature)
+
+    now = time.monotonic()
+    if now - last_plot >= PLOT_PERIOD:
+        save_plot()
+        return now
+    return last_plot
+
+
+def save_plot():
+    plt.figure(figsize=(9, 5))
+    plt.plot(time_data, temp_data, label="Temperature", color="red")
+
+    plt.xlabel("Time")
+    plt.ylabel("Temperature (°C)")
+    plt.title("Temperature over Time")
+    plt.legend()
+
+    # Format x-axis as time
+    plt.gca().xaxis.set_major_formatter(mdates.DateFormatter("%H:%M:%S"))
+    plt.gcf().autofmt_xdate()  # rotate time labels
+
+    plt.tight_layout()
+    plt.savefig("temperature_graph.png")
+    plt.close()
+
+
+async def poll(client, period):
+    """Read the temperature characteristic every period seconds."""
+    last_plot = 0.0
+    while client.is_connected:
+        try:
+            sample = decode_temperature(await client.read_gatt_char(TEMP_UUID))
+            fault = f" fault=0x{sample['fault']:02x}" if sample["fault"] else ""
+            print(f"🌡️ Temperature: {sample['temperature']:.2f} °C "
+                  f"(CJ {sample['cold_junction']:.2f} °C){fault}")
+            last_plot = add_point(sample["temperature"], last_plot)
+        except Exception as e:
+            print(f"⚠️ Read error: {e}")
+
+        await asyncio.sleep(period)
+
+
+async def main(args):
     print(f"🔍 Scanning for '{DEVICE_NAME}' ...")
     devices = await BleakScanner.discover()
 
@@ -42,62 +128,60 @@ async def main():
 
         print("✅ Connected! Saving graph as image...\n")
 
+        # One read gives the current value without waiting for a sample
         try:
-            while True:
-                try:
-                    # Read CHAR1 (low byte)
-                    low_val = await client.read_gatt_char(CHAR_UUIDS["CHAR1"])
-                    low_val = low_val[0]
-
-                    # Try CHAR2 first (high byte)
-                    try:
-                        high_val = await client.read_gatt_char(CHAR_UUIDS["CHAR2"])
-                        high_val = high_val[0]
-                    except Exception:
-                        # fallback to CHAR3
-                        high_val = await client.read_gatt_char(CHAR_UUIDS["CHAR3"])
-                        high_val = high_val[0]
-
-                    # Reconstruct float (scaled by 100 in firmware)
-                    temp_scaled = (high_val << 8) | low_val
-                    temperature = temp_scaled / 100.0
-
-                    # Log
-                    print(f"🌡️ Temperature: {temperature:.2f} °C")
-
-                    # Append to graph data
-                    now = datetime.now()
-                    time_data.append(now)
-                    temp_data.append(temperature)
-
-                    # Update and save plot as image
-                    plt.figure(figsize=(9, 5))
-                    plt.plot(time_data, temp_data, label="Temperature", color="red")
-
-                    plt.xlabel("Time")
-                    plt.ylabel("Temperature (°C)")
-                    plt.title("Temperature over Time")
-                    plt.legend()
-
-                    # Format x-axis as time
-                    plt.gca().xaxis.set_major_formatter(mdates.DateFormatter("%H:%M:%S"))
-                    plt.gcf().autofmt_xdate()  # rotate time labels
-
-                    plt.tight_layout()
-                    plt.savefig("temperature_graph.png")
-                    plt.close()
-
-                except Exception as e:
-                    print(f"⚠️ Read error: {e}")
-
-                await asyncio.sleep(1)  # sample every 1s
+            sample = decode_temperature(await client.read_gatt_char(TEMP_UUID))
+            print(f"🌡️ Current temperature: {sample['temperature']:.2f} °C "
+                  f"(CJ {sample['cold_junction']:.2f} °C)")
+        except Exception as e:
+            print(f"⚠️ Read error: {e}")
+
+        if args.poll:
+            await poll(client, args.poll)
+            return
+
+        last_seq = None
+        last_plot = 0.0
+
+        def on_sample(_, data):
+            nonlocal last_plot, last_seq
+            try:
+                samples = decode_stream(data)
+            except struct.error as e:
+                print(f"⚠️ Bad notification ({len(data)} bytes): {e}")
+                return
+
+            for sample in samples:
+                # The sequence number counts every sample the node produced,
+                # across all channels
+                channel = sample["channel"]
+                if last_seq is not None:
+                    lost = (sample["seq"] - last_seq - 1) & 0xFFFF
+                    if lost:
+                        print(f"⚠️ {lost} sample(s) lost")
+                last_seq = sample["seq"]
+
+                fault = f" fault=0x{sample['fault']:02x}" if sample["fault"] else ""
+                print(f"🌡️ CH{channel} Temperature: {sample['temperature']:.2f} °C "
+                      f"(CJ {sample['cold_junction']:.2f} °C, t={sample['timestamp_ms']} ms){fault}")
+
+                if channel == 0:
+                    last_plot = add_point(sample["temperature"], last_plot)
 
+        try:
+            await client.start_notify(STREAM_UUID, on_sample)
+            while client.is_connected:
+                await asyncio.sleep(1)
         except Exception as e:
             print(f"⚠️ Loop error: {e}")
 
 
 if __name__ == "__main__":
     try:
-        asyncio.run(main())
+        parser = argparse.ArgumentParser(description="Plot the node's thermocouple temperature")
+        parser.add_argument("--poll", type=float, metavar="SECONDS",
+                            help="read the temperature characteristic every SECONDS "
+                                 "instead of subscribing to the stream")
+        asyncio.run(main(parser.parse_args()))
     except KeyboardInterrupt:
         print("\n⏹️ Stopped by user")
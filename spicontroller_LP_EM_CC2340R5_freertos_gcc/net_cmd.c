@@ -0,0 +1,53 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "net_cmd.h"
+
+uint16_t net_cmd_next(const uint8_t *buf, uint16_t len, NetCmd *cmd)
+{
+    uint16_t i = 0;
+
+    cmd->payload = NULL;
+
+    // Resynchronize on the magic byte after garbage
+    while (i < len && buf[i] != NET_CMD_MAGIC) {
+        i++;
+    }
+
+    if (len - i < NET_CMD_HDR_LEN || len - i < NET_CMD_HDR_LEN + buf[i + 2]) {
+        // Partial command: keep it, drop what came before
+        return i;
+    }
+
+    cmd->op      = buf[i + 1];
+    cmd->len     = buf[i + 2];
+    cmd->payload = &buf[i + NET_CMD_HDR_LEN];
+
+    return i + NET_CMD_HDR_LEN + cmd->len;
+}
+
+uint16_t net_cmd_get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+uint32_t net_cmd_get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+uint8_t *net_cmd_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (v >> 8) & 0xFF;
+    p[1] = v & 0xFF;
+    return p + 2;
+}
+
+uint8_t *net_cmd_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (v >> 24) & 0xFF;
+    p[1] = (v >> 16) & 0xFF;
+    p[2] = (v >> 8) & 0xFF;
+    p[3] = v & 0xFF;
+    return p + 4;
+}
@@ -0,0 +1,69 @@
+/*
+ *  ======== net_cmd.h ========
+ *  Binary command protocol on the W5500 command socket.
+ *
+ *  Every message is a 3-byte header followed by len payload bytes, all
+ *  multi-byte fields big-endian:
+ *
+ *    0  uint8  magic   NET_CMD_MAGIC ('C') from the host,
+ *                      NET_CMD_REPLY_MAGIC ('R') from the node
+ *    1  uint8  op      NET_CMD_OP_xxx
+ *    2  uint8  len     payload length
+ *
+ *  Requests:
+ *    SET_RATE    uint32 periodMs
+ *    SET_THRESH  int32 loCenti, int32 hiCenti
+ *    SET_BATCH   uint16 maxSamples, uint32 maxAgeMs
+ *    DUMP        (none)
+ *
+ *  Every request is answered with the same op and a uint8 NET_CMD_STATUS_xxx,
+ *  followed for DUMP by the node's settings and counters.
+ *
+ *  The parser works on the receive buffer in place: a command's payload
+ *  pointer refers into the caller's buffer, nothing is copied.
+ */
+#ifndef NET_CMD_H_
+#define NET_CMD_H_
+
+#include <stdint.h>
+
+#define NET_CMD_MAGIC       (0x43)
+#define NET_CMD_REPLY_MAGIC (0x52)
+#define NET_CMD_HDR_LEN     (3)
+#define NET_CMD_MAX_LEN     (NET_CMD_HDR_LEN + 255)
+
+#define NET_CMD_OP_SET_RATE   (0x01)
+#define NET_CMD_OP_SET_THRESH (0x02)
+#define NET_CMD_OP_SET_BATCH  (0x03)
+#define NET_CMD_OP_DUMP       (0x04)
+
+#define NET_CMD_STATUS_OK      (0x00)
+#define NET_CMD_STATUS_BAD_OP  (0x01)
+#define NET_CMD_STATUS_BAD_LEN (0x02)
+#define NET_CMD_STATUS_BAD_ARG (0x03)
+
+typedef struct
+{
+    uint8_t        op;
+    uint8_t        len;
+    const uint8_t *payload;  /* into the receive buffer */
+} NetCmd;
+
+/*
+ *  ======== net_cmd_next ========
+ *  Find the next complete command in buf[0..len). Bytes before a magic
+ *  byte are skipped. Returns the bytes consumed up to and including the
+ *  command and fills *cmd, or returns the bytes that can be discarded with
+ *  cmd->payload = NULL when no complete command is there yet.
+ */
+uint16_t net_cmd_next(const uint8_t *buf, uint16_t len, NetCmd *cmd);
+
+/* Big-endian field access into a command payload */
+uint16_t net_cmd_get16(const uint8_t *p);
+uint32_t net_cmd_get32(const uint8_t *p);
+
+/* Big-endian field output into a reply, returns p past the field */
+uint8_t *net_cmd_put16(uint8_t *p, uint16_t v);
+uint8_t *net_cmd_put32(uint8_t *p, uint32_t v);
+
+#endif /* NET_CMD_H_ */
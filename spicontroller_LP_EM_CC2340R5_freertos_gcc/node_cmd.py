@@ -0,0 +1,89 @@
+import socket
+import struct
+import sys
+
+HOST = '192.168.1.50'   # W5500 IP
+PORT = 7000
+
+# Command protocol, see net_cmd.h
+HDR = struct.Struct('>BBB')
+MAGIC = 0x43
+REPLY_MAGIC = 0x52
+
+OP_SET_RATE = 0x01
+OP_SET_THRESH = 0x02
+OP_SET_BATCH = 0x03
+OP_DUMP = 0x04
+
+STATUS = {0: 'ok', 1: 'bad op', 2: 'bad length', 3: 'bad argument'}
+
+# DUMP reply after the status byte
+DUMP = struct.Struct('>IHIiiHI')
+
+
+def encode(op, payload=b''):
+    return HDR.pack(MAGIC, op, len(payload)) + payload
+
+
+def recv_reply(sock):
+    """
+    Read one reply, returns (op, status, payload after the status byte).
+    """
+    data = b''
+    while len(data) < HDR.size or len(data) < HDR.size + data[2]:
+        chunk = sock.recv(512)
+        if not chunk:
+            raise ConnectionError("node closed the connection")
+        data += chunk
+    magic, op, length = HDR.unpack(data[:HDR.size])
+    if magic != REPLY_MAGIC or length < 1:
+        raise ValueError(f"bad reply {data!r}")
+    payload = data[HDR.size:HDR.size + length]
+    return op, payload[0], payload[1:]
+
+
+def selftest():
+    assert encode(OP_SET_RATE, struct.pack('>I', 500)) == b'C\x01\x04\x00\x00\x01\xf4'
+    assert encode(OP_DUMP) == b'C\x04\x00'
+    assert DUMP.size == 24
+    print("selftest ok")
+
+
+def usage():
+    print("usage: node_cmd.py rate <ms> | thresh <lo C> <hi C> | batch <N> <T ms> | dump")
+    sys.exit(1)
+
+
+def main(args):
+    if not args:
+        usage()
+    cmd = args[0]
+    if cmd == 'rate' and len(args) == 2:
+        req = encode(OP_SET_RATE, struct.pack('>I', int(args[1])))
+    elif cmd == 'thresh' and len(args) == 3:
+        lo, hi = (round(float(a) * 100) for a in args[1:])
+        req = encode(OP_SET_THRESH, struct.pack('>ii', lo, hi))
+    elif cmd == 'batch' and len(args) == 3:
+        req = encode(OP_SET_BATCH, struct.pack('>HI', int(args[1]), int(args[2])))
+    elif cmd == 'dump' and len(args) == 1:
+        req = encode(OP_DUMP)
+    else:
+        usage()
+
+    with socket.create_connection((HOST, PORT), timeout=5) as s:
+        s.sendall(req)
+        op, status, payload = recv_reply(s)
+
+    print(f"{cmd}: {STATUS.get(status, hex(status))}")
+    if op == OP_DUMP and status == 0:
+        period, n, t, lo, hi, queued, dropped = DUMP.unpack(payload[:DUMP.size])
+        print(f"  sample period {period} ms, batch N={n} T={t} ms")
+        print(f"  alarm band {lo / 100:.2f} .. {hi / 100:.2f} C")
+        print(f"  queued {queued}, dropped {dropped}")
+
+
+if __name__ == '__main__':
+    if len(sys.argv) > 1 and sys.argv[1] == '--selftest':
+        selftest()
+    else:
+        main(sys.argv[1:])
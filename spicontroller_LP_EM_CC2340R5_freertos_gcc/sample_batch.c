@@ -0,0 +1,152 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/* POSIX Header files */
+#include <semaphore.h>
+
+#include "sample_batch.h"
+#include "sample_ring.h"
+#include "telemetry.h"
+
+/* Offset of timeMs in a packed frame, see telemetry.h */
+#define SAMPLE_BATCH_TIME_OFS (8)
+
+static SampleBatch_Config batchCfg;
+static sem_t wakeSem;
+
+/* Set by the producer, cleared by the consumer when it flushes */
+static volatile bool flushNow = false;
+
+/* Set by sample_batch_kick(), cleared when the consumer sees it */
+static volatile bool kicked = false;
+
+/* Producer only: alarm/fault state of the previous sample */
+static uint8_t lastState = 0;
+
+static uint32_t sample_batch_nowMs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* A batch can't outgrow the ring it is queued in */
+static uint16_t sample_batch_clamp(uint16_t n)
+{
+    if (n == 0) {
+        return 1;
+    }
+    return (n > SAMPLE_RING_LEN) ? SAMPLE_RING_LEN : n;
+}
+
+bool sample_batch_init(const SampleBatch_Config *cfg)
+{
+    batchCfg = *cfg;
+    batchCfg.maxSamples = sample_batch_clamp(cfg->maxSamples);
+    return sem_init(&wakeSem, 0, 0) == 0;
+}
+
+void sample_batch_set_limits(uint16_t maxSamples, uint32_t maxAgeMs)
+{
+    batchCfg.maxSamples = sample_batch_clamp(maxSamples);
+    batchCfg.maxAgeMs   = maxAgeMs;
+    sem_post(&wakeSem);
+}
+
+void sample_batch_set_alarm(int32_t loCenti, int32_t hiCenti)
+{
+    batchCfg.alarmLoCenti = loCenti;
+    batchCfg.alarmHiCenti = hiCenti;
+}
+
+void sample_batch_get_config(SampleBatch_Config *cfg)
+{
+    *cfg = batchCfg;
+}
+
+bool sample_batch_submit(Telem_Sample *s)
+{
+    uint16_t queued;
+    uint8_t state;
+    bool wasEmpty = (sample_ring_count() == 0);
+
+    if (!(s->flags & TELEM_FLAG_NO_SENSOR) &&
+        (s->tempCenti < batchCfg.alarmLoCenti || s->tempCenti > batchCfg.alarmHiCenti)) {
+        s->flags |= TELEM_FLAG_ALARM;
+    }
+
+    if (!sample_ring_push(s)) {
+        // Sender is behind; it is already awake or about to be
+        return false;
+    }
+
+    // Only a change of alarm or fault state is urgent, not every sample in it
+    state = (s->flags & TELEM_FLAG_ALARM) | (s->fault != 0 ? TELEM_FLAG_FAULT : 0);
+    if (state != lastState) {
+        lastState = state;
+        flushNow = true;
+    }
+
+    queued = sample_ring_count();
+    if (flushNow || wasEmpty || queued >= batchCfg.maxSamples) {
+        // On an empty ring the sender only needs to start the age timer
+        sem_post(&wakeSem);
+    }
+
+    return true;
+}
+
+void sample_batch_kick(void)
+{
+    kicked = true;
+    sem_post(&wakeSem);
+}
+
+bool sample_batch_wait(void)
+{
+    const uint8_t *rec;
+    struct timespec ts;
+    uint32_t oldestMs;
+    uint32_t waitedMs;
+    uint32_t leftMs;
+
+    while (1) {
+        if (kicked) {
+            kicked = false;
+            return false;
+        }
+
+        if (sample_ring_peek(0, &rec) == 0) {
+            sem_wait(&wakeSem);
+            continue;
+        }
+
+        if (flushNow || sample_ring_count() >= batchCfg.maxSamples) {
+            break;
+        }
+
+        oldestMs = ((uint32_t)rec[SAMPLE_BATCH_TIME_OFS] << 24) |
+                   ((uint32_t)rec[SAMPLE_BATCH_TIME_OFS + 1] << 16) |
+                   ((uint32_t)rec[SAMPLE_BATCH_TIME_OFS + 2] << 8) |
+                   rec[SAMPLE_BATCH_TIME_OFS + 3];
+        waitedMs = sample_batch_nowMs() - oldestMs;
+        if (waitedMs >= batchCfg.maxAgeMs) {
+            break;
+        }
+        leftMs = batchCfg.maxAgeMs - waitedMs;
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec  += leftMs / 1000;
+        ts.tv_nsec += (long)(leftMs % 1000) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        sem_timedwait(&wakeSem, &ts);
+    }
+
+    flushNow = false;
+    return true;
+}
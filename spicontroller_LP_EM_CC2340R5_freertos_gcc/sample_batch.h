@@ -0,0 +1,65 @@
+/*
+ *  ======== sample_batch.h ========
+ *  Flush policy between the sample ring and the network sender.
+ *
+ *  Samples queue in the ring until maxSamples are waiting or the oldest has
+ *  waited maxAgeMs, whichever comes first, so every send carries a batch
+ *  while latency stays bounded by maxAgeMs. A sample that enters or leaves
+ *  the alarm band, or changes the fault status, flushes the batch at once.
+ */
+#ifndef SAMPLE_BATCH_H_
+#define SAMPLE_BATCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "telemetry.h"
+
+#define SAMPLE_BATCH_MAX_SAMPLES_DEFAULT (8)
+#define SAMPLE_BATCH_MAX_AGE_MS_DEFAULT  (5000)
+
+/* Default alarm band is the K-type range, i.e. no alarm */
+#define SAMPLE_BATCH_ALARM_LO_DEFAULT (-27000)
+#define SAMPLE_BATCH_ALARM_HI_DEFAULT (137200)
+
+typedef struct
+{
+    uint16_t maxSamples;   /* N: flush once this many are queued, <= SAMPLE_RING_LEN */
+    uint32_t maxAgeMs;     /* T: flush once the oldest is this old */
+    int32_t  alarmLoCenti; /* thermocouple alarm band, 0.01 degC */
+    int32_t  alarmHiCenti;
+} SampleBatch_Config;
+
+/*
+ *  ======== sample_batch_init ========
+ *  Set the policy; call before the sensor and network threads start.
+ */
+bool sample_batch_init(const SampleBatch_Config *cfg);
+
+/* Change N/T or the alarm band at run time */
+void sample_batch_set_limits(uint16_t maxSamples, uint32_t maxAgeMs);
+void sample_batch_set_alarm(int32_t loCenti, int32_t hiCenti);
+void sample_batch_get_config(SampleBatch_Config *cfg);
+
+/*
+ *  ======== sample_batch_submit ========
+ *  Producer side: flag s against the alarm band, queue it in the sample
+ *  ring and wake the sender if a flush is due. Returns false if the ring
+ *  was full.
+ */
+bool sample_batch_submit(Telem_Sample *s);
+
+/*
+ *  ======== sample_batch_wait ========
+ *  Consumer side: block until the queued samples should be sent (returns
+ *  true) or sample_batch_kick() is called (returns false).
+ */
+bool sample_batch_wait(void);
+
+/*
+ *  ======== sample_batch_kick ========
+ *  Wake the consumer for other work. Safe from interrupts.
+ */
+void sample_batch_kick(void);
+
+#endif /* SAMPLE_BATCH_H_ */
@@ -0,0 +1,60 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sample_ring.h"
+#include "telemetry.h"
+
+static uint8_t ring[SAMPLE_RING_LEN][TELEM_FRAME_LEN];
+
+/* Free-running counters: head written by the producer, tail by the consumer */
+static uint32_t head = 0;
+static uint32_t tail = 0;
+static uint32_t dropped = 0;
+
+bool sample_ring_push(const Telem_Sample *s)
+{
+    uint32_t h = head;
+    uint32_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+
+    if (h - t >= SAMPLE_RING_LEN) {
+        dropped++;
+        return false;
+    }
+
+    telemetry_pack(ring[h & (SAMPLE_RING_LEN - 1)], s);
+
+    // Slot contents must be visible before the consumer sees the new head
+    __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint16_t sample_ring_peek(uint16_t skip, const uint8_t **rec)
+{
+    uint32_t t = tail + skip;
+    uint32_t avail = __atomic_load_n(&head, __ATOMIC_ACQUIRE) - t;
+    uint32_t idx = t & (SAMPLE_RING_LEN - 1);
+    uint32_t run = SAMPLE_RING_LEN - idx;
+
+    if ((int32_t)avail <= 0) {
+        return 0;
+    }
+
+    *rec = ring[idx];
+    return (uint16_t)((avail < run) ? avail : run);
+}
+
+void sample_ring_consume(uint16_t n)
+{
+    // Done reading the slots before the producer may reuse them
+    __atomic_store_n(&tail, tail + n, __ATOMIC_RELEASE);
+}
+
+uint16_t sample_ring_count(void)
+{
+    return (uint16_t)(__atomic_load_n(&head, __ATOMIC_ACQUIRE) - tail);
+}
+
+uint32_t sample_ring_dropped(void)
+{
+    return dropped;
+}
@@ -0,0 +1,52 @@
+/*
+ *  ======== sample_ring.h ========
+ *  Lock-free single-producer/single-consumer ring of packed sample frames.
+ *
+ *  The sensor thread packs each reading straight into a slot and publishes
+ *  it by advancing head; the network thread reads runs of slots in place
+ *  and hands them to the W5500 without copying, then advances tail. Each
+ *  index is written by one side only, so no lock is needed; the acquire/
+ *  release accesses order slot contents against the index update.
+ *
+ *  When the ring is full the new sample is dropped and counted, so a stalled
+ *  network never blocks sampling.
+ */
+#ifndef SAMPLE_RING_H_
+#define SAMPLE_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "telemetry.h"
+
+/* Slots, power of two */
+#define SAMPLE_RING_LEN (32)
+
+/*
+ *  ======== sample_ring_push ========
+ *  Producer side: pack s into the next free slot. Returns false, and counts
+ *  a drop, if the ring is full.
+ */
+bool sample_ring_push(const Telem_Sample *s);
+
+/*
+ *  ======== sample_ring_peek ========
+ *  Consumer side: point *rec at the skip'th unread frame and return how
+ *  many unread frames follow it contiguously (stopping at the end of the
+ *  ring). Frames are TELEM_FRAME_LEN bytes each.
+ */
+uint16_t sample_ring_peek(uint16_t skip, const uint8_t **rec);
+
+/*
+ *  ======== sample_ring_consume ========
+ *  Consumer side: release the n oldest frames back to the producer.
+ */
+void sample_ring_consume(uint16_t n);
+
+/* Unread frames */
+uint16_t sample_ring_count(void);
+
+/* Samples dropped because the ring was full */
+uint32_t sample_ring_dropped(void);
+
+#endif /* SAMPLE_RING_H_ */
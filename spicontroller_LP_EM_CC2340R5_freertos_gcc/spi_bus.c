@@ -0,0 +1,187 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* POSIX Header files */
+#include <semaphore.h>
+
+/* Driver Header files */
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/SPI.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+#include "spi_bus.h"
+
+typedef struct SpiBus_Waiter
+{
+    const SpiBus_Device *dev;
+    sem_t sem;
+    struct SpiBus_Waiter *next;
+} SpiBus_Waiter;
+
+static uint_least8_t busIndex;
+static SPI_Handle busHandle = NULL;
+
+/* Settings the handle is currently open with */
+static SPI_FrameFormat openFormat;
+static uint32_t openBitRate;
+
+/* Owner and waiters change under HwiP_disable(); release runs from callbacks */
+static const SpiBus_Device *owner = NULL;
+static SpiBus_Waiter *waiters = NULL;
+
+/* Completion of spi_bus_transfer(), one blocking transfer at a time */
+static sem_t xferDoneSem;
+static volatile bool xferOk;
+
+/*
+ *  ======== spiBusCallbackFxn ========
+ *  Transfer callback for the bus, forwarded to the owning device.
+ */
+static void spiBusCallbackFxn(SPI_Handle spi, SPI_Transaction *trans)
+{
+    const SpiBus_Device *dev = owner;
+
+    if (dev != NULL && dev->callbackFxn != NULL) {
+        dev->callbackFxn(spi, trans);
+        return;
+    }
+
+    xferOk = (trans->status == SPI_TRANSFER_COMPLETED);
+    sem_post(&xferDoneSem);
+}
+
+static bool spi_bus_configure(const SpiBus_Device *dev)
+{
+    SPI_Params spiParams;
+
+    if (busHandle != NULL) {
+        if (dev->frameFormat == openFormat && dev->bitRate == openBitRate) {
+            return true;
+        }
+        SPI_close(busHandle);
+    }
+
+    SPI_Params_init(&spiParams);
+    spiParams.dataSize            = 8;
+    spiParams.frameFormat         = dev->frameFormat;
+    spiParams.bitRate             = dev->bitRate;
+    spiParams.transferMode        = SPI_MODE_CALLBACK;
+    spiParams.transferCallbackFxn = spiBusCallbackFxn;
+
+    // The driver hands back the same config entry for index on every open
+    busHandle = SPI_open(busIndex, &spiParams);
+    if (busHandle == NULL) {
+        return false;
+    }
+
+    openFormat  = dev->frameFormat;
+    openBitRate = dev->bitRate;
+    return true;
+}
+
+SPI_Handle spi_bus_open(uint_least8_t index, const SpiBus_Device *dev)
+{
+    if (busHandle != NULL) {
+        return busHandle;
+    }
+
+    if (sem_init(&xferDoneSem, 0, 0) != 0) {
+        return NULL;
+    }
+
+    busIndex = index;
+    if (!spi_bus_configure(dev)) {
+        return NULL;
+    }
+
+    return busHandle;
+}
+
+bool spi_bus_acquire(const SpiBus_Device *dev)
+{
+    SpiBus_Waiter self;
+    SpiBus_Waiter **pp;
+    uintptr_t key;
+
+    key = HwiP_disable();
+    if (owner == NULL) {
+        owner = dev;
+        HwiP_restore(key);
+    } else {
+        self.dev = dev;
+        sem_init(&self.sem, 0, 0);
+
+        // Behind every waiter of the same or higher priority
+        pp = &waiters;
+        while (*pp != NULL && (*pp)->dev->priority >= dev->priority) {
+            pp = &(*pp)->next;
+        }
+        self.next = *pp;
+        *pp = &self;
+        HwiP_restore(key);
+
+        // spi_bus_release() makes us the owner before posting
+        sem_wait(&self.sem);
+        sem_destroy(&self.sem);
+    }
+
+    // Nothing is in flight while the bus changes hands
+    if (!spi_bus_configure(dev)) {
+        spi_bus_release(dev);
+        return false;
+    }
+
+    return true;
+}
+
+void spi_bus_release(const SpiBus_Device *dev)
+{
+    SpiBus_Waiter *next;
+    uintptr_t key;
+
+    key = HwiP_disable();
+    if (owner != dev) {
+        HwiP_restore(key);
+        return;
+    }
+
+    next = waiters;
+    if (next != NULL) {
+        waiters = next->next;
+        owner = next->dev;
+    } else {
+        owner = NULL;
+    }
+    HwiP_restore(key);
+
+    if (next != NULL) {
+        sem_post(&next->sem);
+    }
+}
+
+bool spi_bus_transfer(const SpiBus_Device *dev, const uint8_t *txBuf, uint8_t *rxBuf, uint16_t len)
+{
+    SPI_Transaction trans;
+    bool ok;
+
+    if (!spi_bus_acquire(dev)) {
+        return false;
+    }
+
+    memset(&trans, 0, sizeof(trans));
+    trans.count = len;
+    trans.txBuf = (void *)txBuf;
+    trans.rxBuf = rxBuf;
+
+    GPIO_write(dev->csGpio, 0);
+    ok = SPI_transfer(busHandle, &trans);
+    if (ok) {
+        sem_wait(&xferDoneSem);
+        ok = xferOk;
+    }
+    GPIO_write(dev->csGpio, 1);
+
+    spi_bus_release(dev);
+    return ok;
+}
@@ -0,0 +1,65 @@
+/*
+ *  ======== spi_bus.h ========
+ *  Shared SPI controller bus for the W5500 and the MAX31856.
+ *
+ *  The bus keeps CONFIG_SPI_CONTROLLER open in callback mode for the whole
+ *  run. Each device describes its frame format, bit rate, CS GPIO and
+ *  priority; the handle is only reopened when the device taking the bus
+ *  needs a different format or rate, so devices should share both. Tasks
+ *  waiting for the bus are queued by device priority (FIFO among equals),
+ *  so the Ethernet and sensor tasks can run concurrently without open/close
+ *  churn.
+ */
+#ifndef SPI_BUS_H_
+#define SPI_BUS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ti/drivers/SPI.h>
+
+/* SCLK every device on the bus runs at: the MAX31856 limit. The W5500 is
+ * clocked down to it, so a hand-over never reopens the controller. */
+#define SPI_BUS_BITRATE (5000000)
+
+typedef struct
+{
+    uint_least8_t   csGpio;       /* chip select, driven low for a transfer */
+    SPI_FrameFormat frameFormat;
+    uint32_t        bitRate;
+    uint8_t         priority;     /* higher is served first */
+    SPI_CallbackFxn callbackFxn;  /* transfer callback while this device owns
+                                     the bus, NULL when only spi_bus_transfer()
+                                     is used */
+} SpiBus_Device;
+
+/*
+ *  ======== spi_bus_open ========
+ *  Open SPI instance index with the settings of dev. Call once before any
+ *  task uses the bus. The returned handle stays valid across reconfiguring.
+ */
+SPI_Handle spi_bus_open(uint_least8_t index, const SpiBus_Device *dev);
+
+/*
+ *  ======== spi_bus_acquire ========
+ *  Block until dev owns the bus, reconfiguring the controller if needed.
+ *  Returns false, with the bus released again, if the controller could
+ *  not be reopened for dev.
+ */
+bool spi_bus_acquire(const SpiBus_Device *dev);
+
+/*
+ *  ======== spi_bus_release ========
+ *  Hand the bus to the highest priority waiter. May be called from the
+ *  owner's transfer callback.
+ */
+void spi_bus_release(const SpiBus_Device *dev);
+
+/*
+ *  ======== spi_bus_transfer ========
+ *  Acquire the bus, run one blocking transfer of len bytes with dev's CS
+ *  asserted, then release. rxBuf may be NULL.
+ */
+bool spi_bus_transfer(const SpiBus_Device *dev, const uint8_t *txBuf, uint8_t *rxBuf, uint16_t len);
+
+#endif /* SPI_BUS_H_ */
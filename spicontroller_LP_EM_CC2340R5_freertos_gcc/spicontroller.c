@@ -1,6 +1,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
 
 /* POSIX Header files */
 #include <pthread.h>
@@ -15,6 +16,17 @@
 /* Driver configuration */
 #include "ti_drivers_config.h"
 
+#include "spi_bus.h"
+#include "w5500.h"
+#include "w5500_conn.h"
+#include "w5500_socket.h"
+#include "w5500_spi.h"
+#include "w5500_retry.h"
+#include "telemetry.h"
+#include "sample_ring.h"
+#include "sample_batch.h"
+#include "net_cmd.h"
+
 #define THREADSTACKSIZE (1024)
 
 #define SPI_MSG_LENGTH (32)
@@ -22,6 +34,47 @@
 
 #define MAX_LOOP (10)
 
+/* W5500 socket assignment */
+#define NET_SOCK_TELEMETRY (0)  /* sample stream to the collector */
+#define NET_SOCK_COMMAND   (1)  /* host command channel */
+#define NET_SOCK_AUX       (2)  /* discovery / diagnostics */
+
+/* Per-socket buffer split in KB, each direction must total <= 16 */
+static const uint8_t netTxBufKB[W5500_MAX_SOCK] = {8, 2, 2, 0, 0, 0, 0, 0};
+static const uint8_t netRxBufKB[W5500_MAX_SOCK] = {2, 4, 2, 0, 0, 0, 0, 0};
+
+/* 1: samples go out as UDP datagrams, 0: over the persistent TCP session */
+#ifndef NET_USE_UDP
+#define NET_USE_UDP (1)
+#endif
+
+/* UDP collector; {255,255,255,255} reaches every collector on the subnet */
+static const uint8_t netUdpDstIP[4] = {192, 168, 1, 100};
+#define NET_UDP_SRC_PORT (5000)
+#define NET_UDP_DST_PORT (6001)
+
+/* Pause before retrying a batch that could not be sent */
+#define NET_RETRY_MS (100)
+
+/* TCP port of the command channel, see net_cmd.h */
+#define NET_CMD_PORT (7000)
+
+/* TCP failure detection: the retry time tracks the measured round trip
+ * within these bounds, and a dead peer raises TIMEOUT inside the window */
+#define NET_RTO_MIN_US     (10000)
+#define NET_RTO_MAX_US     (1000000)
+#define NET_FAIL_WINDOW_MS (3000)
+
+/* Idle TCP sessions probe the peer this often, seconds */
+#define NET_KEEPALIVE_S (10)
+
+/* Accepted SET_RATE periods; one conversion takes ~100 ms at 60 Hz */
+#define SENSOR_PERIOD_MIN_MS (100)
+#define SENSOR_PERIOD_MAX_MS (3600000)
+
+/* Longest reply payload, the DUMP: status, period, N, T, lo, hi, queued, dropped */
+#define NET_CMD_REPLY_MAX (1 + 4 + 2 + 4 + 4 + 4 + 2 + 4)
+
 #ifdef DeviceFamily_CC35XX
     #define CONFIG_GPIO_LED_0 GPIO_INVALID_INDEX
     #define CONFIG_GPIO_LED_1 GPIO_INVALID_INDEX
@@ -29,6 +82,37 @@
 
 static Display_Handle display;
 
+/* Shared bus, opened by mainThread before the worker threads start */
+static SPI_Handle controllerSpi;
+
+/* Sample period, set by SET_RATE from the command channel */
+static volatile uint32_t samplePeriodMs = 1000;
+
+/* Command bytes received but not parsed yet; only controllerThread uses it */
+static uint8_t cmdBuf[NET_CMD_MAX_LEN];
+static uint16_t cmdLen = 0;
+
+/* MAX31856 on CS2. Mode 3 and the bus rate like the W5500; the bus rate
+ * is its 5 MHz SCLK limit */
+#define MAX31856_BITRATE  (SPI_BUS_BITRATE)
+#define MAX31856_PRIORITY (2)  /* short transfers, ahead of W5500 bursts */
+
+static const SpiBus_Device max31856Dev = {
+    .csGpio      = CS2,
+    .frameFormat = SPI_POL1_PHA1,
+    .bitRate     = MAX31856_BITRATE,
+    .priority    = MAX31856_PRIORITY,
+    .callbackFxn = NULL,
+};
+
+/* MAX31856 registers */
+#define MAX31856_CR0   (0x00)
+#define MAX31856_CR1   (0x01)
+#define MAX31856_CJTH  (0x0A)  /* CJTH, CJTL, LTCBH, LTCBM, LTCBL, SR follow */
+
+static bool max31856_read_reg(uint8_t reg, uint8_t *buf, uint16_t len);
+static bool max31856_write_reg(uint8_t reg, uint8_t *buf, uint16_t len);
+
 unsigned char controllerRxBuffer[SPI_MSG_LENGTH];
 unsigned char controllerTxBuffer[SPI_MSG_LENGTH];
 
@@ -36,116 +120,266 @@ unsigned char controllerTxBuffer[SPI_MSG_LENGTH];
 sem_t controllerSem;
 
 /*
- *  ======== peripheralReadyFxn ========
- *  Callback function for the GPIO interrupt on CONFIG_SPI_PERIPHERAL_READY.
+ *  ======== netDrainSamples ========
+ *  Move the frames queued by sensorThread from the ring into the W5500 TX
+ *  buffer in place and send them, as one datagram over UDP or as a stream
+ *  over the TCP session. Frames stay queued if the send does not go out.
+ *  Returns false in that case.
  */
+bool netDrainSamples(SPI_Handle spi)
+{
+    const uint8_t *rec;
+    uint16_t n;
+#if NET_USE_UDP
+    uint16_t total = 0;
+
+    // At most two runs: up to the end of the ring, then from its start. A
+    // full ring is SAMPLE_RING_LEN * TELEM_FRAME_LEN = 640 bytes, well
+    // inside one 1472-byte UDP payload, so it always goes as one datagram.
+    while ((n = sample_ring_peek(total, &rec)) > 0) {
+        if (!w5500_sock_put(spi, NET_SOCK_TELEMETRY, rec, n * TELEM_FRAME_LEN)) {
+            return false;
+        }
+        total += n;
+    }
 
- long int count = 0; // keep track of messages
-
+    if (total > 0) {
+        if (!w5500_sock_commit(spi, NET_SOCK_TELEMETRY, netUdpDstIP, NET_UDP_DST_PORT)) {
+            Display_printf(display, 0, 0, "UDP send failed");
+            return false;
+        }
+        sample_ring_consume(total);
+    }
+#else
+    // Reuses the open session; only reconnects after a drop
+    while ((n = sample_ring_peek(0, &rec)) > 0) {
+        if (!w5500_conn_send(spi, rec, n * TELEM_FRAME_LEN)) {
+            Display_printf(display, 0, 0, "TCP send failed");
+            return false;
+        }
+        sample_ring_consume(n);
+    }
+#endif
+    return true;
+}
 
- static bool w5500_read_reg(SPI_Handle spi, uint16_t addr, uint8_t *buf, uint16_t len);
- static bool w5500_write_reg(SPI_Handle spi, uint16_t addr, const uint8_t *buf, uint16_t len);
- static bool max31856_read_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16_t len);
- static bool max31856_write_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16_t len);
- void sendHelloDirect(SPI_Handle spi)
+/*
+ *  ======== netExecCommand ========
+ *  Apply one host command and build its reply payload. Returns the payload
+ *  length.
+ */
+static uint8_t netExecCommand(const NetCmd *cmd, uint8_t *reply)
 {
-uint8_t val;
-uint16_t txptr;
-uint8_t txwr[2];
+    SampleBatch_Config cfg;
+    uint8_t *p = reply + 1;
+    uint32_t period;
+    uint32_t ageMs;
+    uint16_t maxSamples;
+    int32_t lo;
+    int32_t hi;
+
+    reply[0] = NET_CMD_STATUS_OK;
+
+    switch (cmd->op) {
+    case NET_CMD_OP_SET_RATE:
+        if (cmd->len != 4) {
+            reply[0] = NET_CMD_STATUS_BAD_LEN;
+            break;
+        }
+        period = net_cmd_get32(cmd->payload);
+        if (period < SENSOR_PERIOD_MIN_MS || period > SENSOR_PERIOD_MAX_MS) {
+            reply[0] = NET_CMD_STATUS_BAD_ARG;
+            break;
+        }
+        // Picked up by sensorThread after its current sleep
+        samplePeriodMs = period;
+        break;
+
+    case NET_CMD_OP_SET_THRESH:
+        if (cmd->len != 8) {
+            reply[0] = NET_CMD_STATUS_BAD_LEN;
+            break;
+        }
+        lo = (int32_t)net_cmd_get32(cmd->payload);
+        hi = (int32_t)net_cmd_get32(cmd->payload + 4);
+        if (lo >= hi) {
+            reply[0] = NET_CMD_STATUS_BAD_ARG;
+            break;
+        }
+        sample_batch_set_alarm(lo, hi);
+        break;
+
+    case NET_CMD_OP_SET_BATCH:
+        if (cmd->len != 6) {
+            reply[0] = NET_CMD_STATUS_BAD_LEN;
+            break;
+        }
+        maxSamples = net_cmd_get16(cmd->payload);
+        ageMs      = net_cmd_get32(cmd->payload + 2);
+        if (maxSamples == 0 || ageMs == 0) {
+            reply[0] = NET_CMD_STATUS_BAD_ARG;
+            break;
+        }
+        sample_batch_set_limits(maxSamples, ageMs);
+        break;
+
+    case NET_CMD_OP_DUMP:
+        sample_batch_get_config(&cfg);
+        p = net_cmd_put32(p, samplePeriodMs);
+        p = net_cmd_put16(p, cfg.maxSamples);
+        p = net_cmd_put32(p, cfg.maxAgeMs);
+        p = net_cmd_put32(p, (uint32_t)cfg.alarmLoCenti);
+        p = net_cmd_put32(p, (uint32_t)cfg.alarmHiCenti);
+        p = net_cmd_put16(p, sample_ring_count());
+        p = net_cmd_put32(p, sample_ring_dropped());
+        break;
+
+    default:
+        reply[0] = NET_CMD_STATUS_BAD_OP;
+        break;
+    }
 
-// ---------- Configure Socket 0 (TCP) ----------
+    return (uint8_t)(p - reply);
+}
 
+/*
+ *  ======== netServiceCommands ========
+ *  Read whatever arrived on the command socket, run every complete command
+ *  straight out of the receive buffer and answer each one. A command split
+ *  across segments stays buffered until the rest arrives.
+ */
+static void netServiceCommands(SPI_Handle spi)
+{
+    uint8_t reply[NET_CMD_HDR_LEN + NET_CMD_REPLY_MAX];
+    NetCmd cmd;
+    uint16_t off;
+    uint16_t n;
+
+    w5500_sock_poll(spi);
+
+    if (w5500_sock_state(NET_SOCK_COMMAND) == W5500_SOCK_CLOSED) {
+        // Host went away (or never came): wait for the next one
+        cmdLen = 0;
+        w5500_sock_events(NET_SOCK_COMMAND);
+        if (!w5500_sock_listen(spi, NET_SOCK_COMMAND, NET_CMD_PORT)) {
+            Display_printf(display, 0, 0, "Command socket listen failed");
+        }
+        // A host that disappears without FIN is dropped, freeing the socket
+        w5500_retry_set_keepalive(spi, NET_SOCK_COMMAND, NET_KEEPALIVE_S);
+        return;
+    }
 
-// Set TCP mode
-val = 0x01;
-w5500_write_reg(spi, 0x4000, &val, 1);  // Sn_MR
+    // After a FIN the last commands may still sit in the RX buffer
+    if (!(w5500_sock_events(NET_SOCK_COMMAND) & W5500_IR_RECV) &&
+        w5500_sock_state(NET_SOCK_COMMAND) != W5500_SOCK_CLOSE_WAIT) {
+        return;
+    }
 
-// Set source port 5000
-uint8_t sport[2] = {0x13, 0x88};
-w5500_write_reg(spi, 0x4004, sport, 2);
+    do {
+        n = w5500_sock_recv(spi, NET_SOCK_COMMAND, &cmdBuf[cmdLen], sizeof(cmdBuf) - cmdLen);
+        cmdLen += n;
+
+        off = 0;
+        while (1) {
+            off += net_cmd_next(&cmdBuf[off], cmdLen - off, &cmd);
+            if (cmd.payload == NULL) {
+                break;
+            }
+
+            reply[0] = NET_CMD_REPLY_MAGIC;
+            reply[1] = cmd.op;
+            reply[2] = netExecCommand(&cmd, &reply[NET_CMD_HDR_LEN]);
+
+            // One reply in flight at a time; the host reads them in order
+            if (w5500_sock_state(NET_SOCK_COMMAND) == W5500_SOCK_SENDING) {
+                w5500_sock_settle(spi, NET_SOCK_COMMAND, NET_RETRY_MS);
+            }
+            if (!w5500_sock_send(spi, NET_SOCK_COMMAND, reply, NET_CMD_HDR_LEN + reply[2])) {
+                Display_printf(display, 0, 0, "Command reply failed");
+            }
+        }
 
-// Open socket
-val = 0x01;
-w5500_write_reg(spi, 0x4001, &val, 1);
-do { w5500_read_reg(spi, 0x4001, &val, 1); } while (val);
+        // Keep only the unfinished command at the front
+        cmdLen -= off;
+        memmove(cmdBuf, &cmdBuf[off], cmdLen);
 
-// Set destination IP & port (PC)
-uint8_t dstIP[4] = {192, 168, 1, 100};   // PC IP
-uint8_t dstPort[2] = {0x17, 0x70};       // 6000
-w5500_write_reg(spi, 0x400C, dstIP, 4);  // Sn_DIPR
-w5500_write_reg(spi, 0x4010, dstPort, 2);// Sn_DPORT
+        // A full buffer may have left data in the socket
+    } while (n > 0 && cmdLen < sizeof(cmdBuf));
 
-// Connect
-val = 0x04;  // CONNECT
-w5500_write_reg(spi, 0x4001, &val, 1);
-do { w5500_read_reg(spi, 0x4001, &val, 1); } while (val);
+    // Host closed its side and everything it sent is answered: close ours.
+    // With the last reply still SENDING, its SEND_OK wakes us to do it then.
+    if (w5500_sock_state(NET_SOCK_COMMAND) == W5500_SOCK_CLOSE_WAIT) {
+        w5500_sock_disconnect(spi, NET_SOCK_COMMAND);
+    }
 
-// Wait for ESTABLISHED
-do {
-    w5500_read_reg(spi, 0x4003, &val, 1); // Sn_SR
-} while (val != 0x17);
+    w5500_retry_update(spi);
+}
 
-// ---------- Send clean ASCII message ----------
-const char msg[] = "Hello from CC2340!\r\n";
-uint16_t tx_ptr;
-uint8_t tx_buf[2];
+static void sensorDelay(uint32_t ms)
+{
+    if (ms >= 1000) {
+        sleep(ms / 1000);
+    }
+    usleep((ms % 1000) * 1000);
+}
 
-char msg_buf[64];  // buffer to hold "Hello from CC2340! #n"
-uint16_t len = sizeof(msg_buf)-1;
-snprintf(msg_buf, sizeof(msg_buf), "Hello from CC2340! #%d\r\n", count++);
-Display_printf(display, 0, 0, "%s", msg_buf);
+/*
+ *  ======== sensorThread ========
+ *  Reads the MAX31856 every samplePeriodMs over the shared bus and queues
+ *  the sample in the ring; the network side drains it at its own pace.
+ */
+void *sensorThread(void *arg0)
+{
+    static uint32_t seq = 0;
+    Telem_Sample sample;
+    struct timespec ts;
+    uint8_t val;
+    uint8_t regs[6];
+    int32_t tc;
+    int16_t cj;
 
+    // CR0 = 0x80 → Continuous conversion, comparator mode, 60Hz filter
+    val = 0x80;
+    max31856_write_reg(MAX31856_CR0, &val, 1);
 
-// Read TX write pointer
-w5500_read_reg(spi, 0x4024, tx_buf, 2);
-tx_ptr = (tx_buf[0] << 8) | tx_buf[1];
+    // CR1 = 0x03 → K-type thermocouple
+    val = 0x03;
+    max31856_write_reg(MAX31856_CR1, &val, 1);
 
-// Calculate buffer address
-uint16_t offset = tx_ptr & 0x07FF; // 2KB buffer
-uint16_t addr = 0x8000 + offset;
+    Display_printf(display, 0, 0, "MAX31856 configured for K-type");
 
-// Write message bytes
-for (uint16_t i = 0; i < len; i++) {
-    w5500_write_reg(spi, addr + i, (uint8_t*)&msg_buf[i], 1);
-}
+    while (1) {
+        sensorDelay(samplePeriodMs);
 
-// Update TX write pointer
-tx_ptr += len;
-tx_buf[0] = (tx_ptr >> 8) & 0xFF;
-tx_buf[1] = tx_ptr & 0xFF;
-w5500_write_reg(spi, 0x4024, tx_buf, 2);
+        // CJTH..SR in one transaction
+        if (!max31856_read_reg(MAX31856_CJTH, regs, sizeof(regs))) {
+            continue;
+        }
 
-// Send
-uint8_t cmd = 0x20;
-w5500_write_reg(spi, 0x4001, &cmd, 1);
-do { w5500_read_reg(spi, 0x4001, &cmd, 1); } while (cmd != 0);
+        // Linearized TC: 19 bits in LTCBH..LTCBL[7:5], 1/128 degC per LSB
+        tc = (int32_t)(((uint32_t)regs[2] << 24) | ((uint32_t)regs[3] << 16) |
+                       ((uint32_t)regs[4] << 8)) >> 13;
+        // Cold junction: 14 bits in CJTH..CJTL[7:2], 1/64 degC per LSB
+        cj = (int16_t)(((uint16_t)regs[0] << 8) | regs[1]) >> 2;
 
+        clock_gettime(CLOCK_MONOTONIC, &ts);
 
-}
+        sample.seq       = seq++;
+        sample.timeMs    = (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+        sample.tempCenti = (tc * 100) / 128;
+        sample.cjCenti   = (int16_t)((cj * 100) / 64);
+        sample.fault     = regs[5];
+        sample.flags     = 0;
 
-static uint8_t w5500_get_ctrl(uint16_t addr, bool isWrite)
-{
-    uint8_t block;
-
-    if (addr < 0x4000) {
-        // Common registers
-        block = 0x00;
-    } else if (addr < 0x4800) {
-        // Socket 0 registers
-        block = 0x08;
-    } else if (addr >= 0x8000 && addr < 0xA000) {
-        // Socket 0 TX buffer
-        block = 0x10;
-    } else if (addr >= 0xC000 && addr < 0xE000) {
-        // Socket 0 RX buffer
-        block = 0x18;
-    } else {
-        block = 0x00; // fallback
+        // Packed in place; a full ring drops the sample rather than block
+        sample_batch_submit(&sample);
     }
-
-    return block | (isWrite ? 0x04 : 0x00);
 }
 
+/*
+ *  ======== peripheralReadyFxn ========
+ *  Callback function for the GPIO interrupt on CONFIG_SPI_PERIPHERAL_READY.
+ */
 void peripheralReadyFxn(uint_least8_t index)
 {
     sem_post(&controllerSem);
@@ -159,134 +393,72 @@ void peripheralReadyFxn(uint_least8_t index)
 void *controllerThread(void *arg0)
 {
 
-            SPI_Handle controllerSpi;
-    SPI_Params spiParams;
-
-    while (1) {
-
-    /* Open SPI */
-    SPI_Params_init(&spiParams);
-    spiParams.dataSize = 8;
-    spiParams.frameFormat = SPI_POL0_PHA0;
-    spiParams.bitRate = 1000000;
-    controllerSpi = SPI_open(CONFIG_SPI_CONTROLLER, &spiParams);
-    if (controllerSpi == NULL) {
-        Display_printf(display, 0, 0, "Error initializing controller SPI\n");
-        while (1) {}
-    }
-    Display_printf(display, 0, 0, "Controller SPI initialized\n");
 
         uint8_t buf[6];
         // uint8_t reset = 0x80;
         // w5500_write_reg(controllerSpi, 0x0000, &reset, 1);  // MR
-        
-        SPI_Handle spi = controllerSpi;
-        
 
         /* --- VERSIONR (0x0039) --- */
-        if (w5500_read_reg(controllerSpi, 0x0039, buf, 1)) {
+        if (w5500_read_reg(controllerSpi, W5500_VERSIONR, buf, 1)) {
             Display_printf(display, 0, 0, "W5500 VERSIONR: 0x%02x", buf[0]);
         }
 
-        /* --- MAC address (0x0009–0x000E) --- */
-        if (w5500_read_reg(controllerSpi, 0x0009, buf, 6)) {
-            Display_printf(display, 0, 0, "MAC: %02x:%02x:%02x:%02x:%02x:%02x",
-                buf[0], buf[1], buf[2], buf[3], buf[4], buf[5]);
-        }
-
-        /* --- IP address (0x000F–0x0012) --- */
-        if (w5500_read_reg(controllerSpi, 0x000F, buf, 4)) {
-            Display_printf(display, 0, 0, "IP: %d.%d.%d.%d",
-                buf[0], buf[1], buf[2], buf[3]);
-        }
-
         /* --- PHYCFGR (0x002E) --- */
-        if (w5500_read_reg(controllerSpi, 0x002E, buf, 1)) {
+        if (w5500_read_reg(controllerSpi, W5500_PHYCFGR, buf, 1)) {
             Display_printf(display, 0, 0, "PHYCFGR: 0x%02x %s",
                 buf[0], (buf[0] & 0x01) ? "LinkUP" : "LinkDOWN");
         }
 
-        uint8_t status;
-w5500_read_reg(controllerSpi, 0x4003, &status, 1); // Sn_SR
-Display_printf(display, 0, 0, "Sn_SR: 0x%02x", status);
-
-uint8_t mac[6] = {0x00,0x08,0xDC,0x11,0x22,0x33}; // unique MAC
-uint8_t ip[4]  = {192,168,1,50};  // W5500 IP
-uint8_t sub[4] = {255,255,255,0}; // Subnet mask
-uint8_t gw[4]  = {192,168,1,1};   // Gateway (can be 192.168.1.1 or 0.0.0.0 if direct PC connection)
-
-w5500_write_reg(spi, 0x0001, gw, 4);   // GAR
-w5500_write_reg(spi, 0x0005, sub, 4);  // SUBR
-w5500_write_reg(spi, 0x0009, mac, 6);  // SHAR
-w5500_write_reg(spi, 0x000F, ip, 4);   // SIPR
-
-
-
-sleep(1);
-sendHelloDirect(controllerSpi);
-
-
-
-
-
-        SPI_close(controllerSpi);
-
-        sleep(1);
-        
-
-//////////////  Thermo couple //////////////////////////////////////////////////
-//         uint8_t regVal;
-//    SPI_Params_init(&spiParams);
-//     spiParams.dataSize = 8;
-//     spiParams.frameFormat = SPI_POL0_PHA1;
-//     spiParams.bitRate = 1000000;
-//     controllerSpi = SPI_open(CONFIG_SPI_CONTROLLER, &spiParams);
-//     if (controllerSpi == NULL) {
-//         Display_printf(display, 0, 0, "Error initializing controller SPI\n");
-//         while (1) {}
-//     }
-//     Display_printf(display, 0, 0, "Controller SPI initialized\n");
-
-
-// // Configure MAX31856 for K-type
-// uint8_t val;
-
-// // CR0 = 0x80 → Continuous conversion, comparator mode, 50Hz filter
-// val = 0x80;
-// max31856_write_reg(controllerSpi, 0x00, &val, 1);
-
-// // CR1 = 0x03 → K-type thermocouple
-// val = 0x03;
-// max31856_write_reg(controllerSpi, 0x01, &val, 1);
+    // Telemetry is TX-heavy, the command channel RX-heavy
+    if (!w5500_set_buf_sizes(controllerSpi, netTxBufKB, netRxBufKB)) {
+        Display_printf(display, 0, 0, "W5500 buffer sizing failed");
+    }
 
-// Display_printf(display, 0, 0, "MAX31856 configured for K-type");
+    W5500_ConnConfig netCfg = {
+        .mac     = {0x00,0x08,0xDC,0x11,0x22,0x33}, // unique MAC
+        .ip      = {192,168,1,50},   // W5500 IP
+        .subnet  = {255,255,255,0},  // Subnet mask
+        .gateway = {192,168,1,1},    // Gateway (can be 192.168.1.1 or 0.0.0.0 if direct PC connection)
+        .dstIP   = {192,168,1,100},  // PC IP
+        .sock    = NET_SOCK_TELEMETRY,
+        .srcPort = 5000,
+        .dstPort = 6000,
+        .eventTimeoutMs = 5000,
+    };
+
+    /* GAR/SUBR/SHAR/SIPR are written once here, not per message */
+    if (!w5500_conn_init(controllerSpi, &netCfg)) {
+        Display_printf(display, 0, 0, "W5500 init failed");
+        while (1) {}
+    }
 
-// // Read CR0 (0x00)
-// if (max31856_read_reg(controllerSpi, 0x00, &regVal, 1)) {
-//     Display_printf(display, 0, 0, "CR0: 0x%02x", regVal);
-// }
+    W5500_RetryConfig retryCfg = {
+        .rtoMinUs     = NET_RTO_MIN_US,
+        .rtoMaxUs     = NET_RTO_MAX_US,
+        .failWindowMs = NET_FAIL_WINDOW_MS,
+    };
+    w5500_retry_adaptive(controllerSpi, &retryCfg);
 
-// // Read Fault Status (0x0F)
-// if (max31856_read_reg(controllerSpi, 0x0A, &regVal, 1)) {
-//     Display_printf(display, 0, 0, "CJTH: 0x%02x", regVal);
-// }
-// if (max31856_read_reg(controllerSpi, 0x0B, &regVal, 1)) {
-//     Display_printf(display, 0, 0, "CJTL: 0x%02x", regVal);
-// }
-// uint8_t tempRaw[3];
-// if (max31856_read_reg(controllerSpi, 0x0C, tempRaw, 3)) {
-//     int32_t raw = ((int32_t)tempRaw[0] << 16) | ((int32_t)tempRaw[1] << 8) | tempRaw[2];
-//     raw >>= 5; // D23–D5 are valid
+#if NET_USE_UDP
+    if (!w5500_sock_udp_open(controllerSpi, NET_SOCK_TELEMETRY, NET_UDP_SRC_PORT, NULL)) {
+        Display_printf(display, 0, 0, "W5500 UDP open failed");
+        while (1) {}
+    }
+#else
+    // Keepalive is TCP only; w5500_conn connects on the first send
+    w5500_retry_set_keepalive(controllerSpi, NET_SOCK_TELEMETRY, NET_KEEPALIVE_S);
+#endif
 
-        //     float tempC = raw * 0.0078125f; // 1 LSB = 0.0078125 °C
-        //     Display_printf(display, 0, 0, "Thermocouple Temp: %.2f C",
-        //     tempC);
-        // }
+    // Commands are served from this thread too: W5500 interrupts wake it
+    w5500_sock_set_notify(sample_batch_kick);
+    netServiceCommands(controllerSpi);
 
-        // SPI_close(controllerSpi);
-        // sleep(1);
-        // //////////////  Thermo couple
-        // //////////////////////////////////////////////////
+    while (1) {
+        // Sleeps until N samples, T ms, an alarm/fault change or a W5500 interrupt
+        if (sample_batch_wait() && !netDrainSamples(controllerSpi)) {
+            usleep(NET_RETRY_MS * 1000);
+        }
+        netServiceCommands(controllerSpi);
     }
 
     SPI_close(controllerSpi);
@@ -294,9 +466,8 @@ sendHelloDirect(controllerSpi);
     return NULL;
 }
 
-static bool max31856_write_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16_t len)
+static bool max31856_write_reg(uint8_t reg, uint8_t *buf, uint16_t len)
 {
-    SPI_Transaction trans;
     uint8_t txBuf[1 + 8] = {0};
 
     if (len > 8) return false;
@@ -307,22 +478,13 @@ static bool max31856_write_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16
         txBuf[1 + i] = buf[i];
     }
 
-    memset(&trans, 0, sizeof(trans));
-    trans.count = 1 + len;
-    trans.txBuf = txBuf;
-    trans.rxBuf = NULL;
-
-    GPIO_write(CS2, 0);
-    bool ok = SPI_transfer(spi, &trans);
-    GPIO_write(CS2, 1);
-
-    return ok;
+    // CS2 is driven by the bus for the length of the transfer
+    return spi_bus_transfer(&max31856Dev, txBuf, NULL, 1 + len);
 }
 
 
-static bool max31856_read_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16_t len)
+static bool max31856_read_reg(uint8_t reg, uint8_t *buf, uint16_t len)
 {
-    SPI_Transaction trans;
     uint8_t txBuf[1 + 8] = {0};   // addr + up to 8 bytes
     uint8_t rxBuf[1 + 8] = {0};
 
@@ -331,18 +493,7 @@ static bool max31856_read_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16_
     // First byte = register address (MSB=0 → read)
     txBuf[0] = reg & 0x7F;
 
-    memset(&trans, 0, sizeof(trans));
-    trans.count = 1 + len;        // 1 addr + len data
-    trans.txBuf = txBuf;
-    trans.rxBuf = rxBuf;
-
-    // Assert CS
-    GPIO_write(CS2, 0);
-
-    bool ok = SPI_transfer(spi, &trans);
-
-    // Deassert CS
-    GPIO_write(CS2, 1);
+    bool ok = spi_bus_transfer(&max31856Dev, txBuf, rxBuf, 1 + len);
 
     if (ok) {
         for (int i = 0; i < len; i++) {
@@ -353,68 +504,13 @@ static bool max31856_read_reg(SPI_Handle spi, uint8_t reg, uint8_t *buf, uint16_
 }
 
 
-static bool w5500_read_reg(SPI_Handle spi, uint16_t addr, uint8_t *buf, uint16_t len)
-{
-    SPI_Transaction trans;
-    uint8_t txBuf[3 + 8] = {0};
-    uint8_t rxBuf[3 + 8] = {0};
-
-    if (len > 8) return false;
-
-    txBuf[0] = (addr >> 8) & 0xFF;
-    txBuf[1] = addr & 0xFF;
-    txBuf[2] = w5500_get_ctrl(addr, false);  // <-- FIX HERE
-
-    memset(&trans, 0, sizeof(trans));
-    trans.count = 3 + len;
-    trans.txBuf = txBuf;
-    trans.rxBuf = rxBuf;
-
-    GPIO_write(CONFIG_GPIO_SPI_CONTROLLER_CSN, 0);
-    bool ok = SPI_transfer(spi, &trans);
-    GPIO_write(CONFIG_GPIO_SPI_CONTROLLER_CSN, 1);
-
-    if (ok) {
-        for (int i = 0; i < len; i++) {
-            buf[i] = rxBuf[3 + i];
-        }
-    }
-    return ok;
-}
-
-static bool w5500_write_reg(SPI_Handle spi, uint16_t addr, const uint8_t *buf, uint16_t len)
-{
-    SPI_Transaction trans;
-    uint8_t txBuf[3 + 8] = {0};
-
-    if (len > 8) return false;
-
-    txBuf[0] = (addr >> 8) & 0xFF;
-    txBuf[1] = addr & 0xFF;
-    txBuf[2] = w5500_get_ctrl(addr, true);  // <-- FIX HERE
-    for (int i = 0; i < len; i++) {
-        txBuf[3 + i] = buf[i];
-    }
-
-    memset(&trans, 0, sizeof(trans));
-    trans.count = 3 + len;
-    trans.txBuf = txBuf;
-    trans.rxBuf = NULL;
-
-    GPIO_write(CONFIG_GPIO_SPI_CONTROLLER_CSN, 0);
-    bool ok = SPI_transfer(spi, &trans);
-    GPIO_write(CONFIG_GPIO_SPI_CONTROLLER_CSN, 1);
-
-    return ok;
-}
-
-
 /*
  *  ======== mainThread ========
  */
 void *mainThread(void *arg0)
 {
     pthread_t thread0;
+    pthread_t thread1;
     pthread_attr_t attrs;
     struct sched_param priParam;
     int retc;
@@ -466,6 +562,26 @@ void *mainThread(void *arg0)
         while (1) {}
     }
 
+    /* Open SPI once for both devices; the bus reconfigures per device.
+     * Callback mode: W5500 frames are double-buffered and DMA'd back to back. */
+    GPIO_write(CS2, 1);
+    controllerSpi = w5500_spi_open(CONFIG_SPI_CONTROLLER, W5500_SPI_BITRATE);
+    if (controllerSpi == NULL) {
+        Display_printf(display, 0, 0, "Error initializing controller SPI\n");
+        while (1) {}
+    }
+    Display_printf(display, 0, 0, "Controller SPI initialized\n");
+
+    SampleBatch_Config batchCfg = {
+        .maxSamples   = SAMPLE_BATCH_MAX_SAMPLES_DEFAULT,
+        .maxAgeMs     = SAMPLE_BATCH_MAX_AGE_MS_DEFAULT,
+        .alarmLoCenti = SAMPLE_BATCH_ALARM_LO_DEFAULT,
+        .alarmHiCenti = SAMPLE_BATCH_ALARM_HI_DEFAULT,
+    };
+    if (!sample_batch_init(&batchCfg)) {
+        while (1) {}
+    }
+
     /* Create controller thread */
     priParam.sched_priority = 1;
     pthread_attr_setschedparam(&attrs, &priParam);
@@ -477,5 +593,16 @@ void *mainThread(void *arg0)
         while (1) {}
     }
 
+    /* Create sensor thread, one above the controller so readings stay on time */
+    priParam.sched_priority = 2;
+    pthread_attr_setschedparam(&attrs, &priParam);
+
+    retc = pthread_create(&thread1, &attrs, sensorThread, NULL);
+    if (retc != 0)
+    {
+        /* pthread_create() failed */
+        while (1) {}
+    }
+
     return (NULL);
 }
\ No newline at end of file
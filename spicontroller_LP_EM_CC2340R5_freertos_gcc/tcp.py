@@ -1,5 +1,7 @@
 import socket
 
+from udp_rx import decode_all, show
+
 HOST = '0.0.0.0'
 PORT = 6000
 
@@ -13,13 +15,17 @@ with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as s:
             conn, addr = s.accept()
             print(f"Connected by {addr}")
             with conn:
+                pending = b''
                 while True:
                     try:
                         data = conn.recv(1024)
                         if not data:
                             print("Client disconnected")
                             break
-                        print("Received:", data.decode('utf-8', errors='ignore'))
+                        # Binary sample frames, may be split across reads
+                        samples, pending = decode_all(pending + data)
+                        for sample in samples:
+                            show(addr, sample)
                     except ConnectionResetError:
                         print("Connection reset by remote host")
                         break
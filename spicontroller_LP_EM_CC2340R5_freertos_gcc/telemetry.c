@@ -0,0 +1,41 @@
+#include <stdint.h>
+
+#include "telemetry.h"
+
+static uint8_t *telemetry_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (v >> 8) & 0xFF;
+    p[1] = v & 0xFF;
+    return p + 2;
+}
+
+static uint8_t *telemetry_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (v >> 24) & 0xFF;
+    p[1] = (v >> 16) & 0xFF;
+    p[2] = (v >> 8) & 0xFF;
+    p[3] = v & 0xFF;
+    return p + 4;
+}
+
+uint16_t telemetry_pack(uint8_t *buf, const Telem_Sample *s)
+{
+    uint8_t *p = buf;
+    uint8_t flags = s->flags;
+
+    if (s->fault != 0) {
+        flags |= TELEM_FLAG_FAULT;
+    }
+
+    p = telemetry_put16(p, TELEM_MAGIC);
+    *p++ = TELEM_VERSION;
+    *p++ = flags;
+    p = telemetry_put32(p, s->seq);
+    p = telemetry_put32(p, s->timeMs);
+    p = telemetry_put32(p, (uint32_t)s->tempCenti);
+    p = telemetry_put16(p, (uint16_t)s->cjCenti);
+    *p++ = s->fault;
+    *p++ = 0;
+
+    return (uint16_t)(p - buf);
+}
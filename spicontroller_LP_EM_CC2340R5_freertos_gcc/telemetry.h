@@ -0,0 +1,51 @@
+/*
+ *  ======== telemetry.h ========
+ *  Binary sample frame sent to the collectors.
+ *
+ *  Fixed 20-byte layout, all fields big-endian (network order):
+ *
+ *    0  uint16  magic       TELEM_MAGIC ("TC")
+ *    2  uint8   version     TELEM_VERSION
+ *    3  uint8   flags       TELEM_FLAG_xxx
+ *    4  uint32  seq         increments per frame, gaps = lost datagrams
+ *    8  uint32  timeMs      sender uptime
+ *   12  int32   tempCenti   thermocouple, 0.01 degC
+ *   16  int16   cjCenti     cold junction, 0.01 degC
+ *   18  uint8   fault       MAX31856 SR
+ *   19  uint8   reserved
+ *
+ *  udp_rx.py next to this file decodes the same layout.
+ */
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+
+#define TELEM_MAGIC   (0x5443)
+#define TELEM_VERSION (1)
+
+#define TELEM_FRAME_LEN (20)
+
+/* flags */
+#define TELEM_FLAG_NO_SENSOR (0x01)  /* temperature fields not valid */
+#define TELEM_FLAG_FAULT     (0x02)  /* fault byte is non-zero */
+#define TELEM_FLAG_ALARM     (0x04)  /* tempCenti outside the alarm band */
+
+typedef struct
+{
+    uint32_t seq;
+    uint32_t timeMs;
+    int32_t  tempCenti;
+    int16_t  cjCenti;
+    uint8_t  fault;
+    uint8_t  flags;
+} Telem_Sample;
+
+/*
+ *  ======== telemetry_pack ========
+ *  Serialize s into buf, which must hold TELEM_FRAME_LEN bytes. Returns
+ *  the frame length.
+ */
+uint16_t telemetry_pack(uint8_t *buf, const Telem_Sample *s);
+
+#endif /* TELEMETRY_H_ */
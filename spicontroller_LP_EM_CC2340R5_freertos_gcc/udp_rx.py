@@ -0,0 +1,110 @@
+import socket
+import struct
+import sys
+
+HOST = '0.0.0.0'
+PORT = 6001
+
+# Multicast group to join, or None for unicast/broadcast
+GROUP = None
+
+# Sample frame, see telemetry.h
+FRAME = struct.Struct('>HBBIIihBx')
+MAGIC = 0x5443
+VERSION = 1
+
+FLAG_NO_SENSOR = 0x01
+FLAG_FAULT = 0x02
+FLAG_ALARM = 0x04
+
+
+def decode(data):
+    """
+    Decode one sample frame, returns a dict or None if it isn't one.
+    """
+    if len(data) != FRAME.size:
+        return None
+    magic, version, flags, seq, time_ms, temp, cj, fault = FRAME.unpack(data)
+    if magic != MAGIC or version != VERSION:
+        return None
+    return {
+        'seq': seq,
+        'time_ms': time_ms,
+        'temp_c': temp / 100.0,
+        'cj_c': cj / 100.0,
+        'fault': fault,
+        'flags': flags,
+    }
+
+
+def decode_all(data):
+    """
+    Split a datagram (or a chunk of the TCP stream) into frames. Returns
+    the decoded samples and any trailing partial frame.
+    """
+    samples = []
+    end = len(data) - len(data) % FRAME.size
+    for off in range(0, end, FRAME.size):
+        sample = decode(data[off:off + FRAME.size])
+        if sample is not None:
+            samples.append(sample)
+    return samples, data[end:]
+
+
+def selftest():
+    frame = FRAME.pack(MAGIC, VERSION, FLAG_FAULT, 7, 123456, -2575, 2150, 0x40)
+    s = decode(frame)
+    assert s == {'seq': 7, 'time_ms': 123456, 'temp_c': -25.75, 'cj_c': 21.5,
+                 'fault': 0x40, 'flags': FLAG_FAULT}, s
+    assert decode(frame[:-1]) is None
+    assert decode(b'\x00' + frame[1:]) is None
+    batch, rest = decode_all(frame * 3 + frame[:5])
+    assert len(batch) == 3 and rest == frame[:5], (batch, rest)
+    print("selftest ok")
+
+
+def show(addr, sample):
+    if sample['flags'] & FLAG_NO_SENSOR:
+        temp = "no sensor"
+    else:
+        temp = f"{sample['temp_c']:.2f} C (CJ {sample['cj_c']:.2f} C)"
+    if sample['flags'] & FLAG_FAULT:
+        temp += f" fault 0x{sample['fault']:02x}"
+    if sample['flags'] & FLAG_ALARM:
+        temp += " ALARM"
+    print(f"{addr[0]} #{sample['seq']} t={sample['time_ms']} ms: {temp}")
+
+
+def main():
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as s:
+        s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        s.bind((HOST, PORT))
+        if GROUP:
+            mreq = struct.pack('4s4s', socket.inet_aton(GROUP), socket.inet_aton('0.0.0.0'))
+            s.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+        print(f"Listening for samples on UDP port {PORT}...")
+
+        last_seq = None
+        while True:
+            try:
+                data, addr = s.recvfrom(2048)
+            except KeyboardInterrupt:
+                print("Receiver stopped by user")
+                break
+
+            samples, rest = decode_all(data)
+            if not samples or rest:
+                print(f"Ignored {len(data)} bytes from {addr}")
+
+            for sample in samples:
+                if last_seq is not None and sample['seq'] != (last_seq + 1) & 0xFFFFFFFF:
+                    print(f"Lost {(sample['seq'] - last_seq - 1) & 0xFFFFFFFF} frame(s)")
+                last_seq = sample['seq']
+                show(addr, sample)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) > 1 and sys.argv[1] == '--selftest':
+        selftest()
+    else:
+        main()
@@ -0,0 +1,152 @@
+#include <stddef.h>
+#include <stdint.h>
+
+/* Driver Header files */
+#include <ti/drivers/SPI.h>
+
+#include "w5500.h"
+#include "w5500_spi.h"
+
+/* Buffer sizes in KB as programmed into Sn_TXBUF_SIZE/Sn_RXBUF_SIZE */
+static uint8_t txBufKB[W5500_MAX_SOCK] = {
+    W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT,
+    W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT
+};
+static uint8_t rxBufKB[W5500_MAX_SOCK] = {
+    W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT,
+    W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT, W5500_SOCK_BUF_KB_DEFAULT
+};
+
+static uint8_t w5500_get_ctrl(uint8_t block, bool isWrite)
+{
+    // OM bits stay 00: variable length data mode, frame length set by CS
+    return (uint8_t)(block << 3) | (isWrite ? 0x04 : 0x00);
+}
+
+/*
+ *  ======== w5500_frame ========
+ *  Run one variable-length data mode frame through the double-buffered
+ *  transfer layer. Header and payload go out as one DMA transaction.
+ */
+static bool w5500_frame(SPI_Handle spi, uint8_t block, uint16_t offset, bool isWrite,
+                        const uint8_t *txData, uint8_t *rxData, uint16_t len)
+{
+    return w5500_spi_frame(spi, w5500_get_ctrl(block, isWrite), offset, txData, rxData, len);
+}
+
+bool w5500_read(SPI_Handle spi, uint8_t block, uint16_t offset, uint8_t *buf, uint16_t len)
+{
+    return w5500_frame(spi, block, offset, false, NULL, buf, len);
+}
+
+bool w5500_write(SPI_Handle spi, uint8_t block, uint16_t offset, const uint8_t *buf, uint16_t len)
+{
+    return w5500_frame(spi, block, offset, true, buf, NULL, len);
+}
+
+bool w5500_read_reg(SPI_Handle spi, uint16_t addr, uint8_t *buf, uint16_t len)
+{
+    return w5500_frame(spi, W5500_BLOCK_COMMON, addr, false, NULL, buf, len);
+}
+
+bool w5500_write_reg(SPI_Handle spi, uint16_t addr, const uint8_t *buf, uint16_t len)
+{
+    return w5500_frame(spi, W5500_BLOCK_COMMON, addr, true, buf, NULL, len);
+}
+
+bool w5500_read_sreg(SPI_Handle spi, uint8_t sn, uint8_t reg, uint8_t *buf, uint16_t len)
+{
+    if (sn >= W5500_MAX_SOCK) return false;
+    return w5500_frame(spi, W5500_BLOCK_SREG(sn), reg, false, NULL, buf, len);
+}
+
+bool w5500_write_sreg(SPI_Handle spi, uint8_t sn, uint8_t reg, const uint8_t *buf, uint16_t len)
+{
+    if (sn >= W5500_MAX_SOCK) return false;
+    return w5500_frame(spi, W5500_BLOCK_SREG(sn), reg, true, buf, NULL, len);
+}
+
+static bool w5500_valid_buf_kb(uint8_t kb)
+{
+    return kb == 0 || kb == 1 || kb == 2 || kb == 4 || kb == 8 || kb == 16;
+}
+
+bool w5500_set_buf_sizes(SPI_Handle spi, const uint8_t txKB[W5500_MAX_SOCK],
+                         const uint8_t rxKB[W5500_MAX_SOCK])
+{
+    uint16_t txTotal = 0;
+    uint16_t rxTotal = 0;
+    uint8_t sn;
+
+    for (sn = 0; sn < W5500_MAX_SOCK; sn++) {
+        if (!w5500_valid_buf_kb(txKB[sn]) || !w5500_valid_buf_kb(rxKB[sn])) return false;
+        txTotal += txKB[sn];
+        rxTotal += rxKB[sn];
+    }
+    if (txTotal > W5500_BUF_TOTAL_KB || rxTotal > W5500_BUF_TOTAL_KB) return false;
+
+    for (sn = 0; sn < W5500_MAX_SOCK; sn++) {
+        if (!w5500_write_sreg(spi, sn, W5500_Sn_TXBUF_SIZE, &txKB[sn], 1) ||
+            !w5500_write_sreg(spi, sn, W5500_Sn_RXBUF_SIZE, &rxKB[sn], 1)) {
+            return false;
+        }
+        txBufKB[sn] = txKB[sn];
+        rxBufKB[sn] = rxKB[sn];
+    }
+    return true;
+}
+
+uint16_t w5500_tx_size(uint8_t sn)
+{
+    return (sn < W5500_MAX_SOCK) ? (uint16_t)txBufKB[sn] * 1024 : 0;
+}
+
+uint16_t w5500_rx_size(uint8_t sn)
+{
+    return (sn < W5500_MAX_SOCK) ? (uint16_t)rxBufKB[sn] * 1024 : 0;
+}
+
+bool w5500_write_tx(SPI_Handle spi, uint8_t sn, uint16_t ptr, const uint8_t *data, uint16_t len)
+{
+    uint16_t size = w5500_tx_size(sn);
+    uint16_t offset;
+    uint16_t first;
+
+    if (len == 0) return true;
+    if (len > size) return false;
+
+    offset = ptr & (size - 1);
+    first = size - offset;
+    if (first > len) first = len;
+
+    if (!w5500_frame(spi, W5500_BLOCK_STX(sn), offset, true, data, NULL, first)) {
+        return false;
+    }
+    if (first < len) {
+        // Wrapped past the end of the ring, continue at its start
+        return w5500_frame(spi, W5500_BLOCK_STX(sn), 0, true, data + first, NULL, len - first);
+    }
+    return true;
+}
+
+bool w5500_read_rx(SPI_Handle spi, uint8_t sn, uint16_t ptr, uint8_t *data, uint16_t len)
+{
+    uint16_t size = w5500_rx_size(sn);
+    uint16_t offset;
+    uint16_t first;
+
+    if (len == 0) return true;
+    if (len > size) return false;
+
+    offset = ptr & (size - 1);
+    first = size - offset;
+    if (first > len) first = len;
+
+    if (!w5500_frame(spi, W5500_BLOCK_SRX(sn), offset, false, NULL, data, first)) {
+        return false;
+    }
+    if (first < len) {
+        return w5500_frame(spi, W5500_BLOCK_SRX(sn), 0, false, NULL, data + first, len - first);
+    }
+    return true;
+}
@@ -0,0 +1,144 @@
+/*
+ *  ======== w5500.h ========
+ *  Register and buffer access for the WIZnet W5500 over SPI.
+ *
+ *  Every access names a block (common registers, or the register block, TX
+ *  buffer or RX buffer of one of the eight sockets) and a 16-bit offset in
+ *  it. w5500_read_reg()/w5500_write_reg() address the common block.
+ */
+#ifndef W5500_H_
+#define W5500_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ti/drivers/SPI.h>
+
+/* SPI frame header: address high, address low, control byte */
+#define W5500_FRAME_HDR_LEN (3)
+
+#define W5500_MAX_SOCK (8)
+
+/* Block select values, shifted into the control byte by the driver */
+#define W5500_BLOCK_COMMON   (0x00)
+#define W5500_BLOCK_SREG(sn) ((uint8_t)((sn) * 4 + 1))
+#define W5500_BLOCK_STX(sn)  ((uint8_t)((sn) * 4 + 2))
+#define W5500_BLOCK_SRX(sn)  ((uint8_t)((sn) * 4 + 3))
+
+/* TX plus RX buffer memory shared by all sockets, in KB each */
+#define W5500_BUF_TOTAL_KB (16)
+
+/* Common registers */
+#define W5500_MR       (0x0000)
+#define W5500_GAR      (0x0001)
+#define W5500_SUBR     (0x0005)
+#define W5500_SHAR     (0x0009)
+#define W5500_SIPR     (0x000F)
+#define W5500_INTLEVEL (0x0013)
+#define W5500_IR       (0x0015)
+#define W5500_IMR      (0x0016)
+#define W5500_SIR      (0x0017)
+#define W5500_SIMR     (0x0018)
+#define W5500_RTR      (0x0019)  /* retry time, 100 us units, all sockets */
+#define W5500_RCR      (0x001B)  /* retry count, all sockets */
+#define W5500_PHYCFGR  (0x002E)
+#define W5500_VERSIONR (0x0039)
+
+/* Socket register offsets within W5500_BLOCK_SREG(sn) */
+#define W5500_Sn_MR     (0x00)
+#define W5500_Sn_CR     (0x01)
+#define W5500_Sn_IR     (0x02)
+#define W5500_Sn_SR     (0x03)
+#define W5500_Sn_PORT   (0x04)
+#define W5500_Sn_DHAR   (0x06)
+#define W5500_Sn_DIPR   (0x0C)
+#define W5500_Sn_DPORT  (0x10)
+#define W5500_Sn_RXBUF_SIZE (0x1E)
+#define W5500_Sn_TXBUF_SIZE (0x1F)
+#define W5500_Sn_TX_FSR (0x20)
+#define W5500_Sn_TX_WR  (0x24)
+#define W5500_Sn_RX_RSR (0x26)
+#define W5500_Sn_RX_RD  (0x28)
+#define W5500_Sn_IMR    (0x2C)
+#define W5500_Sn_KPALVTR (0x2F)  /* TCP keepalive period, 5 s units, 0 = off */
+
+/* Sn_MR protocol and options */
+#define W5500_MR_TCP   (0x01)
+#define W5500_MR_UDP   (0x02)
+#define W5500_MR_MACRAW (0x04) /* socket 0 only */
+#define W5500_MR_MULTI (0x80)  /* UDP multicast, group set in Sn_DIPR/DHAR/DPORT */
+
+/* Sn_MR options of a MACRAW socket */
+#define W5500_MR_MFEN   (0x80)  /* MAC filter: only our SHAR, broadcast, multicast */
+#define W5500_MR_BCASTB (0x40)  /* block broadcast */
+#define W5500_MR_MMB    (0x20)  /* block multicast */
+#define W5500_MR_MIP6B  (0x10)  /* block IPv6 */
+
+/* Sn_CR commands */
+#define W5500_CR_OPEN    (0x01)
+#define W5500_CR_LISTEN  (0x02)
+#define W5500_CR_CONNECT (0x04)
+#define W5500_CR_DISCON  (0x08)
+#define W5500_CR_CLOSE   (0x10)
+#define W5500_CR_SEND    (0x20)
+#define W5500_CR_RECV    (0x40)
+
+/* Sn_IR / Sn_IMR bits */
+#define W5500_IR_CON     (0x01)
+#define W5500_IR_DISCON  (0x02)
+#define W5500_IR_RECV    (0x04)
+#define W5500_IR_TIMEOUT (0x08)
+#define W5500_IR_SEND_OK (0x10)
+
+/* Sn_SR values */
+#define W5500_SR_CLOSED      (0x00)
+#define W5500_SR_INIT        (0x13)
+#define W5500_SR_LISTEN      (0x14)
+#define W5500_SR_ESTABLISHED (0x17)
+#define W5500_SR_CLOSE_WAIT  (0x1C)
+#define W5500_SR_UDP         (0x22)
+#define W5500_SR_MACRAW      (0x42)
+
+/* Socket buffer size after reset (Sn_TXBUF_SIZE/Sn_RXBUF_SIZE = 2), in KB */
+#define W5500_SOCK_BUF_KB_DEFAULT (2)
+
+bool w5500_read(SPI_Handle spi, uint8_t block, uint16_t offset, uint8_t *buf, uint16_t len);
+bool w5500_write(SPI_Handle spi, uint8_t block, uint16_t offset, const uint8_t *buf, uint16_t len);
+
+/* Common register access */
+bool w5500_read_reg(SPI_Handle spi, uint16_t addr, uint8_t *buf, uint16_t len);
+bool w5500_write_reg(SPI_Handle spi, uint16_t addr, const uint8_t *buf, uint16_t len);
+
+/* Socket register access, reg is a W5500_Sn_xxx offset */
+bool w5500_read_sreg(SPI_Handle spi, uint8_t sn, uint8_t reg, uint8_t *buf, uint16_t len);
+bool w5500_write_sreg(SPI_Handle spi, uint8_t sn, uint8_t reg, const uint8_t *buf, uint16_t len);
+
+/*
+ *  ======== w5500_set_buf_sizes ========
+ *  Program Sn_TXBUF_SIZE/Sn_RXBUF_SIZE for all eight sockets. Each size is
+ *  0, 1, 2, 4, 8 or 16 KB and each direction may total at most 16 KB.
+ *  A socket given 0 KB cannot carry data in that direction.
+ */
+bool w5500_set_buf_sizes(SPI_Handle spi, const uint8_t txKB[W5500_MAX_SOCK],
+                         const uint8_t rxKB[W5500_MAX_SOCK]);
+
+/* Configured buffer size of socket sn, in bytes */
+uint16_t w5500_tx_size(uint8_t sn);
+uint16_t w5500_rx_size(uint8_t sn);
+
+/*
+ *  ======== w5500_write_tx ========
+ *  Copy len bytes into the TX buffer of socket sn starting at the Sn_TX_WR
+ *  value ptr, split only where it wraps past the end of the ring and into
+ *  W5500_SPI_CHUNK-sized DMA frames. Sn_TX_WR itself is not updated.
+ */
+bool w5500_write_tx(SPI_Handle spi, uint8_t sn, uint16_t ptr, const uint8_t *data, uint16_t len);
+
+/*
+ *  ======== w5500_read_rx ========
+ *  Copy len bytes out of the RX buffer of socket sn starting at the Sn_RX_RD
+ *  value ptr, split as for w5500_write_tx(). Sn_RX_RD itself is not updated.
+ */
+bool w5500_read_rx(SPI_Handle spi, uint8_t sn, uint16_t ptr, uint8_t *data, uint16_t len);
+
+#endif /* W5500_H_ */
@@ -0,0 +1,152 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/* Driver Header files */
+#include <ti/drivers/SPI.h>
+
+#include "w5500.h"
+#include "w5500_socket.h"
+#include "w5500_retry.h"
+#include "w5500_conn.h"
+
+static W5500_ConnConfig connCfg;
+static W5500_ConnStats connStats;
+static bool connWasUp = false;
+
+/* 0 while no connect has failed since the last success */
+static uint32_t backoffMs = 0;
+static uint32_t retryAtMs = 0;
+
+static uint32_t w5500_conn_nowMs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ *  ======== w5500_conn_check ========
+ *  Returns true if the session is established and ready for a SEND.
+ */
+static bool w5500_conn_check(SPI_Handle spi)
+{
+    uint8_t sr;
+
+    w5500_sock_poll(spi);
+
+    if (w5500_sock_state(connCfg.sock) == W5500_SOCK_SENDING) {
+        w5500_sock_settle(spi, connCfg.sock, connCfg.eventTimeoutMs);
+    }
+
+    if (w5500_sock_state(connCfg.sock) == W5500_SOCK_READY) {
+        // A peer that vanished without FIN raises no DISCON; Sn_SR still tells
+        if (w5500_read_sreg(spi, connCfg.sock, W5500_Sn_SR, &sr, 1) &&
+            sr == W5500_SR_ESTABLISHED) {
+            return true;
+        }
+        w5500_sock_close(spi, connCfg.sock);
+    } else if (w5500_sock_state(connCfg.sock) == W5500_SOCK_CLOSE_WAIT) {
+        // The server closed its side; nothing is read here, so close ours
+        w5500_sock_disconnect(spi, connCfg.sock);
+    }
+
+    if (connWasUp) {
+        connStats.drops++;
+        connWasUp = false;
+    }
+    return false;
+}
+
+/*
+ *  ======== w5500_conn_connect ========
+ *  Attempt a handshake unless still inside the backoff window.
+ */
+static bool w5500_conn_connect(SPI_Handle spi)
+{
+    uint8_t phy;
+
+    if (backoffMs != 0 && (int32_t)(w5500_conn_nowMs() - retryAtMs) < 0) {
+        return false;
+    }
+
+    // No point in burning a retry while the cable is out
+    if (!w5500_read_reg(spi, W5500_PHYCFGR, &phy, 1) || !(phy & 0x01)) {
+        return false;
+    }
+
+    if (w5500_sock_connect(spi, connCfg.sock, connCfg.srcPort, connCfg.dstIP, connCfg.dstPort) &&
+        w5500_sock_settle(spi, connCfg.sock, connCfg.eventTimeoutMs) == W5500_SOCK_READY) {
+        connStats.connects++;
+        connWasUp = true;
+        backoffMs = 0;
+        return true;
+    }
+
+    w5500_sock_close(spi, connCfg.sock);
+    connStats.failures++;
+
+    if (backoffMs == 0) {
+        backoffMs = W5500_CONN_BACKOFF_MIN_MS;
+    } else if (backoffMs < W5500_CONN_BACKOFF_MAX_MS / 2) {
+        backoffMs *= 2;
+    } else {
+        backoffMs = W5500_CONN_BACKOFF_MAX_MS;
+    }
+    retryAtMs = w5500_conn_nowMs() + backoffMs;
+
+    return false;
+}
+
+bool w5500_conn_init(SPI_Handle spi, const W5500_ConnConfig *cfg)
+{
+    if (cfg->sock >= W5500_MAX_SOCK) {
+        return false;
+    }
+
+    connCfg = *cfg;
+    memset(&connStats, 0, sizeof(connStats));
+    connWasUp = false;
+    backoffMs = 0;
+
+    w5500_write_reg(spi, W5500_GAR, connCfg.gateway, 4);
+    w5500_write_reg(spi, W5500_SUBR, connCfg.subnet, 4);
+    w5500_write_reg(spi, W5500_SHAR, connCfg.mac, 6);
+    if (!w5500_write_reg(spi, W5500_SIPR, connCfg.ip, 4)) {
+        return false;
+    }
+
+    return w5500_sock_init(spi);
+}
+
+bool w5500_conn_send(SPI_Handle spi, const uint8_t *data, uint16_t len)
+{
+    if (!w5500_conn_check(spi) && !w5500_conn_connect(spi)) {
+        return false;
+    }
+
+    if (!w5500_sock_send(spi, connCfg.sock, data, len)) {
+        return false;
+    }
+
+    // SEND is issued: the data belongs to the chip now, and sending it
+    // again would duplicate it in the stream. A SEND_OK that does not come
+    // in time is settled, or the drop found, by the next check.
+    w5500_sock_settle(spi, connCfg.sock, connCfg.eventTimeoutMs);
+
+    // The handshake and this send each gave a round trip
+    w5500_retry_update(spi);
+    return true;
+}
+
+bool w5500_conn_isUp(void)
+{
+    return w5500_sock_state(connCfg.sock) == W5500_SOCK_READY;
+}
+
+const W5500_ConnStats *w5500_conn_stats(void)
+{
+    return &connStats;
+}
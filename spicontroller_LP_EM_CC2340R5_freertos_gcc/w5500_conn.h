@@ -0,0 +1,63 @@
+/*
+ *  ======== w5500_conn.h ========
+ *  Persistent TCP connection manager on top of the W5500 socket engine.
+ *
+ *  The chip's network identity is written once; the TCP session is then kept
+ *  open across sends. A drop (TIMEOUT interrupt, Sn_SR no longer
+ *  ESTABLISHED, or a FIN from the server) closes the socket, and the next
+ *  send reconnects once the exponential backoff window has passed.
+ */
+#ifndef W5500_CONN_H_
+#define W5500_CONN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ti/drivers/SPI.h>
+
+/* Reconnect backoff bounds */
+#define W5500_CONN_BACKOFF_MIN_MS (500)
+#define W5500_CONN_BACKOFF_MAX_MS (30000)
+
+typedef struct
+{
+    uint8_t  mac[6];     /* SHAR */
+    uint8_t  ip[4];      /* SIPR */
+    uint8_t  subnet[4];  /* SUBR */
+    uint8_t  gateway[4]; /* GAR */
+    uint8_t  dstIP[4];   /* collector address */
+    uint8_t  sock;       /* W5500 socket carrying the session */
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint32_t eventTimeoutMs; /* longest wait for CON/SEND_OK */
+} W5500_ConnConfig;
+
+typedef struct
+{
+    uint32_t connects;   /* successful handshakes */
+    uint32_t drops;      /* established sessions lost */
+    uint32_t failures;   /* connect attempts that did not complete */
+} W5500_ConnStats;
+
+/*
+ *  ======== w5500_conn_init ========
+ *  Write GAR/SUBR/SHAR/SIPR and arm the socket interrupts. Call once after
+ *  the SPI handle is opened.
+ */
+bool w5500_conn_init(SPI_Handle spi, const W5500_ConnConfig *cfg);
+
+/*
+ *  ======== w5500_conn_send ========
+ *  Send len bytes on the persistent session, connecting first if needed.
+ *  Returns true once SEND is issued for them, even if SEND_OK does not
+ *  arrive within eventTimeoutMs; the caller must not send them again.
+ *  Returns false if they never reached Sn_TX, e.g. without touching the
+ *  network while inside the backoff window after a failed connect.
+ */
+bool w5500_conn_send(SPI_Handle spi, const uint8_t *data, uint16_t len);
+
+bool w5500_conn_isUp(void);
+
+const W5500_ConnStats *w5500_conn_stats(void);
+
+#endif /* W5500_CONN_H_ */
@@ -0,0 +1,84 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ti/drivers/SPI.h>
+
+#include "w5500.h"
+#include "w5500_socket.h"
+#include "w5500_macraw.h"
+
+/* Length word in front of every received frame, counting itself */
+#define W5500_MACRAW_HDR_LEN (2)
+
+/* Anything shorter than an Ethernet header means the framing is lost */
+#define W5500_MACRAW_FRAME_MIN (14)
+
+static uint8_t burstBuf[W5500_MACRAW_BURST_LEN];
+static uint8_t openOpts;
+static W5500_MacrawStats stats;
+
+bool w5500_macraw_open(SPI_Handle spi, uint8_t opts)
+{
+    openOpts = opts;
+    return w5500_sock_macraw_open(spi, opts);
+}
+
+uint16_t w5500_macraw_poll(SPI_Handle spi, W5500_MacrawFxn fxn, void *arg)
+{
+    uint16_t frames = 0;
+    uint16_t avail;
+    uint16_t off;
+    uint16_t len;
+
+    while ((avail = w5500_sock_peek(spi, W5500_MACRAW_SOCK, burstBuf, sizeof(burstBuf))) > 0) {
+        stats.rxBursts++;
+
+        // Walk the whole frames in the burst; a cut-off one waits for the next
+        off = 0;
+        while (avail - off >= W5500_MACRAW_HDR_LEN) {
+            len = (burstBuf[off] << 8) | burstBuf[off + 1];
+
+            if (len < W5500_MACRAW_HDR_LEN + W5500_MACRAW_FRAME_MIN ||
+                len > W5500_MACRAW_HDR_LEN + W5500_MACRAW_FRAME_MAX) {
+                // Lost framing: nothing after this can be trusted, and
+                // reopening is the only way to reset the RX pointers
+                stats.rxBad++;
+                w5500_macraw_open(spi, openOpts);
+                return frames;
+            }
+            if (len > avail - off) {
+                break;
+            }
+
+            fxn(&burstBuf[off + W5500_MACRAW_HDR_LEN], len - W5500_MACRAW_HDR_LEN, arg);
+            stats.rxFrames++;
+            stats.rxBytes += len - W5500_MACRAW_HDR_LEN;
+            frames++;
+            off += len;
+        }
+
+        if (off == 0 || !w5500_sock_consume(spi, W5500_MACRAW_SOCK, off)) {
+            break;
+        }
+    }
+
+    return frames;
+}
+
+bool w5500_macraw_send(SPI_Handle spi, const uint8_t *frame, uint16_t len)
+{
+    if (len < W5500_MACRAW_FRAME_MIN || len > W5500_MACRAW_FRAME_MAX ||
+        !w5500_sock_put(spi, W5500_MACRAW_SOCK, frame, len) ||
+        !w5500_sock_commit(spi, W5500_MACRAW_SOCK, NULL, 0)) {
+        stats.txFailed++;
+        return false;
+    }
+
+    stats.txFrames++;
+    return true;
+}
+
+const W5500_MacrawStats *w5500_macraw_stats(void)
+{
+    return &stats;
+}
@@ -0,0 +1,70 @@
+/*
+ *  ======== w5500_macraw.h ========
+ *  Raw Ethernet frames on W5500 socket 0 (Sn_MR = MACRAW).
+ *
+ *  The chip stores each received frame in the socket 0 RX buffer behind a
+ *  2-byte big-endian length that counts itself. w5500_macraw_poll() reads
+ *  as many stored frames as fit its buffer in one burst, hands each to the
+ *  callback in place, then frees them all with one Sn_RX_RD update and one
+ *  RECV, so the per-frame cost is the callback alone. Frames carry the
+ *  Ethernet header but no FCS; the chip appends the FCS on transmit.
+ *
+ *  Other sockets keep working while socket 0 is in MACRAW mode and take
+ *  the traffic addressed to them first, so the telemetry socket has to move
+ *  off socket 0 when the probe is used.
+ */
+#ifndef W5500_MACRAW_H_
+#define W5500_MACRAW_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ti/drivers/SPI.h>
+
+/* MACRAW is only available on socket 0 */
+#define W5500_MACRAW_SOCK (0)
+
+/* Largest frame without FCS: 14-byte header + 1500 payload */
+#define W5500_MACRAW_FRAME_MAX (1514)
+
+/* Receive burst buffer, at least one frame plus its length word */
+#ifndef W5500_MACRAW_BURST_LEN
+#define W5500_MACRAW_BURST_LEN (2048)
+#endif
+
+/* Called for each received frame; frame is only valid during the call */
+typedef void (*W5500_MacrawFxn)(const uint8_t *frame, uint16_t len, void *arg);
+
+typedef struct
+{
+    uint32_t rxFrames;
+    uint32_t rxBytes;
+    uint32_t rxBursts;   /* SPI bursts the frames came in */
+    uint32_t rxBad;      /* length words that could not be a frame; socket reopened */
+    uint32_t txFrames;
+    uint32_t txFailed;
+} W5500_MacrawStats;
+
+/*
+ *  ======== w5500_macraw_open ========
+ *  Open socket 0 in MACRAW mode; opts are W5500_MR_MFEN/BCASTB/MMB/MIP6B.
+ */
+bool w5500_macraw_open(SPI_Handle spi, uint8_t opts);
+
+/*
+ *  ======== w5500_macraw_poll ========
+ *  Deliver every frame waiting in the chip to fxn. Returns the number of
+ *  frames delivered.
+ */
+uint16_t w5500_macraw_poll(SPI_Handle spi, W5500_MacrawFxn fxn, void *arg);
+
+/*
+ *  ======== w5500_macraw_send ========
+ *  Inject one pre-built Ethernet frame (destination MAC first, no FCS).
+ *  Does not wait for SEND_OK; fails while the previous frame is going out.
+ */
+bool w5500_macraw_send(SPI_Handle spi, const uint8_t *frame, uint16_t len);
+
+const W5500_MacrawStats *w5500_macraw_stats(void);
+
+#endif /* W5500_MACRAW_H_ */
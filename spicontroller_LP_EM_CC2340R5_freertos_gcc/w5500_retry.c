@@ -0,0 +1,169 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ti/drivers/SPI.h>
+
+#include "w5500.h"
+#include "w5500_socket.h"
+#include "w5500_retry.h"
+
+/* RTR after reset: 200 ms */
+#define W5500_RTR_DEFAULT (2000)
+#define W5500_RCR_DEFAULT (8)
+
+/* The doubling retry time stops at the 16-bit register range */
+#define W5500_RTR_MAX (0xFFFF)
+
+static bool adaptive = false;
+static W5500_RetryConfig adaptCfg;
+static W5500_RetryStatus status = {
+    .rtoUs = W5500_RTR_DEFAULT * W5500_RTR_UNIT_US,
+    .rcr   = W5500_RCR_DEFAULT,
+};
+
+static uint16_t w5500_retry_rtr(uint32_t retryTimeUs)
+{
+    uint32_t rtr = (retryTimeUs + W5500_RTR_UNIT_US - 1) / W5500_RTR_UNIT_US;
+
+    if (rtr == 0) {
+        rtr = 1;
+    }
+    return (rtr > W5500_RTR_MAX) ? W5500_RTR_MAX : (uint16_t)rtr;
+}
+
+static bool w5500_retry_write(SPI_Handle spi, uint32_t retryTimeUs, uint8_t retryCount)
+{
+    uint16_t rtr = w5500_retry_rtr(retryTimeUs);
+    uint8_t buf[2];
+
+    buf[0] = (rtr >> 8) & 0xFF;
+    buf[1] = rtr & 0xFF;
+    if (!w5500_write_reg(spi, W5500_RTR, buf, 2) ||
+        !w5500_write_reg(spi, W5500_RCR, &retryCount, 1)) {
+        return false;
+    }
+
+    status.rtoUs = (uint32_t)rtr * W5500_RTR_UNIT_US;
+    status.rcr   = retryCount;
+    status.writes++;
+    return true;
+}
+
+uint32_t w5500_retry_window_ms(uint32_t retryTimeUs, uint8_t retryCount)
+{
+    uint32_t t = w5500_retry_rtr(retryTimeUs);
+    uint32_t total = 0;
+    uint16_t n;
+
+    // First transmission plus retryCount retries, each waiting t
+    for (n = 0; n <= retryCount; n++) {
+        total += t;
+        if (t * 2 <= W5500_RTR_MAX) {
+            t *= 2;
+        }
+    }
+    return total * W5500_RTR_UNIT_US / 1000;
+}
+
+/*
+ *  ======== w5500_retry_count ========
+ *  Largest retry count whose sequence fits windowMs, at least 1.
+ */
+static uint8_t w5500_retry_count(uint32_t retryTimeUs, uint32_t windowMs)
+{
+    uint8_t rcr = 1;
+
+    while (rcr < 0xFF && w5500_retry_window_ms(retryTimeUs, rcr + 1) <= windowMs) {
+        rcr++;
+    }
+    return rcr;
+}
+
+bool w5500_retry_set(SPI_Handle spi, uint32_t retryTimeUs, uint8_t retryCount)
+{
+    adaptive = false;
+    return w5500_retry_write(spi, retryTimeUs, retryCount);
+}
+
+bool w5500_retry_set_keepalive(SPI_Handle spi, uint8_t sn, uint16_t seconds)
+{
+    uint16_t units = (seconds + W5500_KPALV_UNIT_S - 1) / W5500_KPALV_UNIT_S;
+    uint8_t val = (units > 0xFF) ? 0xFF : (uint8_t)units;
+
+    if (sn >= W5500_MAX_SOCK) {
+        return false;
+    }
+    return w5500_write_sreg(spi, sn, W5500_Sn_KPALVTR, &val, 1);
+}
+
+bool w5500_retry_adaptive(SPI_Handle spi, const W5500_RetryConfig *cfg)
+{
+    uint32_t rto;
+
+    if (cfg == NULL) {
+        adaptive = false;
+        return true;
+    }
+    if (cfg->rtoMinUs == 0 || cfg->rtoMinUs > cfg->rtoMaxUs) {
+        return false;
+    }
+
+    adaptCfg = *cfg;
+    adaptive = true;
+
+    rto = status.rtoUs;
+    if (rto < adaptCfg.rtoMinUs) {
+        rto = adaptCfg.rtoMinUs;
+    } else if (rto > adaptCfg.rtoMaxUs) {
+        rto = adaptCfg.rtoMaxUs;
+    }
+    return w5500_retry_write(spi, rto, w5500_retry_count(rto, adaptCfg.failWindowMs));
+}
+
+void w5500_retry_update(SPI_Handle spi)
+{
+    uint32_t rtt;
+    uint32_t err;
+    uint32_t rto;
+    bool sampled = false;
+    uint8_t sn;
+
+    for (sn = 0; sn < W5500_MAX_SOCK; sn++) {
+        if (!w5500_sock_take_rtt(sn, &rtt)) {
+            continue;
+        }
+        sampled = true;
+        status.samples++;
+
+        if (status.srttUs == 0) {
+            status.srttUs   = rtt;
+            status.rttvarUs = rtt / 2;
+        } else {
+            err = (status.srttUs > rtt) ? status.srttUs - rtt : rtt - status.srttUs;
+            status.rttvarUs = status.rttvarUs - status.rttvarUs / 4 + err / 4;
+            status.srttUs   = status.srttUs - status.srttUs / 8 + rtt / 8;
+        }
+    }
+
+    if (!adaptive || !sampled) {
+        return;
+    }
+
+    rto = status.srttUs + 4 * status.rttvarUs;
+    if (rto < adaptCfg.rtoMinUs) {
+        rto = adaptCfg.rtoMinUs;
+    } else if (rto > adaptCfg.rtoMaxUs) {
+        rto = adaptCfg.rtoMaxUs;
+    }
+
+    // Leave the chip alone for small moves; each write is two SPI frames
+    err = (rto > status.rtoUs) ? rto - status.rtoUs : status.rtoUs - rto;
+    if (err > status.rtoUs / 8) {
+        w5500_retry_write(spi, rto, w5500_retry_count(rto, adaptCfg.failWindowMs));
+    }
+}
+
+const W5500_RetryStatus *w5500_retry_status(void)
+{
+    return &status;
+}
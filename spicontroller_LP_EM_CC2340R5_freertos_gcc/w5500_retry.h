@@ -0,0 +1,85 @@
+/*
+ *  ======== w5500_retry.h ========
+ *  W5500 retransmission and keepalive tuning.
+ *
+ *  RTR (retry time) and RCR (retry count) are chip-wide: every TCP
+ *  retransmission and ARP request uses them. A TCP segment is resent after
+ *  RTR, then with the timeout doubling up to the 6.5535 s register limit,
+ *  and the socket raises TIMEOUT once RCR retries are spent. The chip
+ *  defaults (200 ms, 8 retries) take over 30 s to declare a link dead.
+ *  Sn_KPALVTR is per socket and makes an idle TCP session probe its peer,
+ *  so a host that vanished without FIN is noticed at all.
+ *
+ *  In adaptive mode the retry time follows the measured round trip of the
+ *  TCP sockets (RFC 6298: RTO = SRTT + 4 * RTTVAR, clamped), and the retry
+ *  count is the largest that keeps the whole retry sequence inside the
+ *  configured failure window.
+ */
+#ifndef W5500_RETRY_H_
+#define W5500_RETRY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ti/drivers/SPI.h>
+
+/* RTR counts in 100 us */
+#define W5500_RTR_UNIT_US (100)
+
+/* Sn_KPALVTR counts in 5 s */
+#define W5500_KPALV_UNIT_S (5)
+
+typedef struct
+{
+    uint32_t rtoMinUs;      /* floor of the retry time */
+    uint32_t rtoMaxUs;      /* ceiling, at most 6553500 */
+    uint32_t failWindowMs;  /* longest retry sequence before TIMEOUT */
+} W5500_RetryConfig;
+
+typedef struct
+{
+    uint32_t srttUs;    /* smoothed round trip, 0 before the first sample */
+    uint32_t rttvarUs;
+    uint32_t rtoUs;     /* retry time in RTR */
+    uint8_t  rcr;       /* retry count in RCR */
+    uint32_t samples;
+    uint32_t writes;    /* RTR/RCR updates sent to the chip */
+} W5500_RetryStatus;
+
+/*
+ *  ======== w5500_retry_set ========
+ *  Program RTR/RCR directly. Turns adaptive mode off.
+ */
+bool w5500_retry_set(SPI_Handle spi, uint32_t retryTimeUs, uint8_t retryCount);
+
+/*
+ *  ======== w5500_retry_set_keepalive ========
+ *  Keepalive period of TCP socket sn, rounded up to 5 s; 0 turns it off.
+ *  Takes effect once the session is established.
+ */
+bool w5500_retry_set_keepalive(SPI_Handle spi, uint8_t sn, uint16_t seconds);
+
+/*
+ *  ======== w5500_retry_window_ms ========
+ *  Time from the first transmission until TIMEOUT for the given settings.
+ */
+uint32_t w5500_retry_window_ms(uint32_t retryTimeUs, uint8_t retryCount);
+
+/*
+ *  ======== w5500_retry_adaptive ========
+ *  Start adaptive tuning with cfg, or stop it with NULL. Programs RCR for
+ *  the window straight away, at the current retry time.
+ */
+bool w5500_retry_adaptive(SPI_Handle spi, const W5500_RetryConfig *cfg);
+
+/*
+ *  ======== w5500_retry_update ========
+ *  Fold in the round trips measured since the last call and reprogram
+ *  RTR/RCR if the retry time moved by more than an eighth. Call after TCP
+ *  sends; cheap when nothing changed.
+ */
+void w5500_retry_update(SPI_Handle spi);
+
+const W5500_RetryStatus *w5500_retry_status(void);
+
+#endif /* W5500_RETRY_H_ */
@@ -0,0 +1,640 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/* POSIX Header files */
+#include <semaphore.h>
+
+/* RTOS header files */
+#include <FreeRTOS.h>
+#include <queue.h>
+
+/* Driver Header files */
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/SPI.h>
+
+/* Driver configuration */
+#include "ti_drivers_config.h"
+
+#include "w5500.h"
+#include "w5500_socket.h"
+
+#define W5500_EVT_QUEUE_LEN (16)
+
+/* Reads of Sn_CR before giving up on the chip accepting a command */
+#define W5500_CR_SPIN_MAX (100)
+
+/* Interrupts raised by each socket */
+#define W5500_Sn_IMR_VAL (W5500_IR_CON | W5500_IR_DISCON | W5500_IR_RECV | \
+                          W5500_IR_TIMEOUT | W5500_IR_SEND_OK)
+
+/* INTn deassert time between interrupts, in 25 ns PLL clocks */
+#define W5500_INTLEVEL_VAL (0x0100)
+
+static sem_t intSem;
+static QueueHandle_t evtQueue;
+static W5500_NotifyFxn notifyFxn = NULL;
+static bool intSetupDone = false;
+static W5500_SockState sockState[W5500_MAX_SOCK];
+static uint8_t sockMode[W5500_MAX_SOCK];  /* Sn_MR written at OPEN */
+static bool peerFin[W5500_MAX_SOCK];      /* DISCON seen on an open TCP session */
+
+/* Message being assembled by w5500_sock_put(): Sn_TX_WR when it started,
+ * bytes written past it so far, and Sn_TX_FSR at the start */
+static uint16_t txWr[W5500_MAX_SOCK];
+static uint16_t txStaged[W5500_MAX_SOCK];
+static uint16_t txFree[W5500_MAX_SOCK];
+
+/* Sn_RX_RD as of the last w5500_sock_peek(), advanced by w5500_sock_consume() */
+static uint16_t rxRd[W5500_MAX_SOCK];
+
+/* Sn_IR bits seen per socket and not yet collected by w5500_sock_events() */
+static uint8_t pendingIr[W5500_MAX_SOCK];
+
+/* TCP round trips: CONNECT to CON and SEND to SEND_OK (which waits for
+ * the peer's ACK). Start time per socket, last sample, unread flag. */
+static uint32_t rttStartUs[W5500_MAX_SOCK];
+static uint32_t rttUs[W5500_MAX_SOCK];
+static bool rttNew[W5500_MAX_SOCK];
+
+static uint32_t w5500_sock_nowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*
+ *  ======== w5500IntFxn ========
+ *  Callback function for the GPIO interrupt on W5500_INT_GPIO. SPI can't
+ *  run from here, so only wake the thread that owns the bus.
+ */
+static void w5500IntFxn(uint_least8_t index)
+{
+    (void)index;
+
+    sem_post(&intSem);
+    if (notifyFxn != NULL) {
+        notifyFxn();
+    }
+}
+
+static bool w5500_sock_cmd(SPI_Handle spi, uint8_t sn, uint8_t cmd)
+{
+    uint8_t val;
+    int i;
+
+    /* Sn_CR clears once the chip has accepted the previous command, which
+     * takes a few SPI clocks - completion is reported through Sn_IR. */
+    for (i = 0; i < W5500_CR_SPIN_MAX; i++) {
+        if (!w5500_read_sreg(spi, sn, W5500_Sn_CR, &val, 1)) {
+            return false;
+        }
+        if (val == 0) {
+            break;
+        }
+    }
+    if (i == W5500_CR_SPIN_MAX) {
+        return false;
+    }
+
+    return w5500_write_sreg(spi, sn, W5500_Sn_CR, &cmd, 1);
+}
+
+/*
+ *  ======== w5500_sock_open ========
+ *  Put socket sn into mode on port and issue OPEN. OPEN completes
+ *  synchronously with no interrupt, so Sn_SR is checked against expectSr.
+ */
+static bool w5500_sock_open(SPI_Handle spi, uint8_t sn, uint8_t mode,
+                            uint16_t port, uint8_t expectSr)
+{
+    uint8_t val;
+    uint8_t portBuf[2];
+
+    if (sn >= W5500_MAX_SOCK) {
+        return false;
+    }
+
+    // OPEN only takes effect from SOCK_CLOSED
+    if (sockState[sn] != W5500_SOCK_CLOSED && !w5500_sock_close(spi, sn)) {
+        return false;
+    }
+
+    w5500_write_sreg(spi, sn, W5500_Sn_MR, &mode, 1);
+    sockMode[sn] = mode;
+
+    portBuf[0] = (port >> 8) & 0xFF;
+    portBuf[1] = port & 0xFF;
+    w5500_write_sreg(spi, sn, W5500_Sn_PORT, portBuf, 2);
+
+    if (!w5500_sock_cmd(spi, sn, W5500_CR_OPEN)) {
+        return false;
+    }
+
+    w5500_read_sreg(spi, sn, W5500_Sn_SR, &val, 1);
+    if (val != expectSr) {
+        w5500_sock_close(spi, sn);
+        return false;
+    }
+
+    pendingIr[sn] = 0;
+    txStaged[sn] = 0;
+    peerFin[sn] = false;
+    return true;
+}
+
+/*
+ *  ======== w5500_sock_idle ========
+ *  State of socket sn with no SEND outstanding.
+ */
+static W5500_SockState w5500_sock_idle(uint8_t sn)
+{
+    return peerFin[sn] ? W5500_SOCK_CLOSE_WAIT : W5500_SOCK_READY;
+}
+
+/*
+ *  ======== w5500_sock_apply ========
+ *  Advance the state machine of socket sn for the Sn_IR bits just cleared.
+ */
+static void w5500_sock_apply(SPI_Handle spi, uint8_t sn, uint8_t ir)
+{
+    if ((sockMode[sn] & 0x0F) == W5500_MR_UDP || (sockMode[sn] & 0x0F) == W5500_MR_MACRAW) {
+        // TIMEOUT here is a failed ARP: the datagram is lost, the socket stays open
+        if ((ir & (W5500_IR_SEND_OK | W5500_IR_TIMEOUT)) && sockState[sn] == W5500_SOCK_SENDING) {
+            sockState[sn] = W5500_SOCK_READY;
+        }
+        return;
+    }
+    if (((ir & W5500_IR_CON) && sockState[sn] == W5500_SOCK_CONNECTING) ||
+        ((ir & W5500_IR_SEND_OK) && sockState[sn] == W5500_SOCK_SENDING)) {
+        // Includes the time until this thread got round to servicing
+        rttUs[sn]  = w5500_sock_nowUs() - rttStartUs[sn];
+        rttNew[sn] = true;
+    }
+    if (ir & W5500_IR_TIMEOUT) {
+        // ARP/TCP retransmission gave up: nothing more will come or go
+        w5500_sock_cmd(spi, sn, W5500_CR_CLOSE);
+        sockState[sn] = W5500_SOCK_CLOSED;
+        return;
+    }
+    if ((ir & W5500_IR_CON) && (sockState[sn] == W5500_SOCK_CONNECTING ||
+                                sockState[sn] == W5500_SOCK_LISTENING)) {
+        sockState[sn] = W5500_SOCK_READY;
+    }
+    if ((ir & W5500_IR_SEND_OK) && sockState[sn] == W5500_SOCK_SENDING) {
+        sockState[sn] = w5500_sock_idle(sn);
+    }
+    if (ir & W5500_IR_DISCON) {
+        if (sockState[sn] == W5500_SOCK_READY || sockState[sn] == W5500_SOCK_SENDING) {
+            // Peer sent FIN: what it sent before is still in the RX buffer and
+            // a reply can still go out. The owner issues DISCON when done.
+            peerFin[sn] = true;
+            if (sockState[sn] == W5500_SOCK_READY) {
+                sockState[sn] = W5500_SOCK_CLOSE_WAIT;
+            }
+        } else if (sockState[sn] == W5500_SOCK_CONNECTING ||
+                   sockState[sn] == W5500_SOCK_LISTENING) {
+            w5500_sock_cmd(spi, sn, W5500_CR_CLOSE);
+            sockState[sn] = W5500_SOCK_CLOSED;
+        }
+        // Otherwise this completes our own DISCON
+    }
+}
+
+/*
+ *  ======== w5500_sock_service ========
+ *  Read and clear pending socket interrupts. INTn is level-low while any
+ *  unmasked Sn_IR bit is set, so keep going until SIR reads clear; an event
+ *  raised while servicing would otherwise produce no new falling edge.
+ */
+static void w5500_sock_service(SPI_Handle spi)
+{
+    W5500_Event evt;
+    uint8_t sir;
+    uint8_t ir;
+    uint8_t sn;
+
+    while (w5500_read_reg(spi, W5500_SIR, &sir, 1) && sir != 0) {
+        for (sn = 0; sn < W5500_MAX_SOCK; sn++) {
+            if (!(sir & (1 << sn))) {
+                continue;
+            }
+            if (!w5500_read_sreg(spi, sn, W5500_Sn_IR, &ir, 1)) {
+                return;
+            }
+            // Sn_IR bits are cleared by writing 1
+            w5500_write_sreg(spi, sn, W5500_Sn_IR, &ir, 1);
+
+            w5500_sock_apply(spi, sn, ir);
+            pendingIr[sn] |= ir;
+
+            // A full queue only loses the wakeup; state and pendingIr hold
+            evt.sock = sn;
+            evt.ir   = ir;
+            xQueueSend(evtQueue, &evt, 0);
+        }
+    }
+}
+
+bool w5500_sock_init(SPI_Handle spi)
+{
+    uint8_t val;
+    uint8_t sn;
+    uint8_t intLevel[2] = {(W5500_INTLEVEL_VAL >> 8) & 0xFF, W5500_INTLEVEL_VAL & 0xFF};
+
+    if (!intSetupDone) {
+        if (sem_init(&intSem, 0, 0) != 0) {
+            return false;
+        }
+        evtQueue = xQueueCreate(W5500_EVT_QUEUE_LEN, sizeof(W5500_Event));
+        if (evtQueue == NULL) {
+            return false;
+        }
+
+        GPIO_setConfig(W5500_INT_GPIO, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_FALLING);
+        GPIO_setCallback(W5500_INT_GPIO, w5500IntFxn);
+        intSetupDone = true;
+    }
+
+    w5500_write_reg(spi, W5500_INTLEVEL, intLevel, 2);
+
+    val = W5500_Sn_IMR_VAL;
+    for (sn = 0; sn < W5500_MAX_SOCK; sn++) {
+        w5500_write_sreg(spi, sn, W5500_Sn_IMR, &val, 1);
+    }
+
+    val = 0xFF; // all sockets
+    if (!w5500_write_reg(spi, W5500_SIMR, &val, 1)) {
+        return false;
+    }
+
+    GPIO_enableInt(W5500_INT_GPIO);
+
+    // INTn may already be low from before the callback was armed
+    w5500_sock_service(spi);
+
+    return true;
+}
+
+bool w5500_sock_connect(SPI_Handle spi, uint8_t sn, uint16_t srcPort,
+                        const uint8_t dstIP[4], uint16_t dstPort)
+{
+    uint8_t port[2];
+
+    if (!w5500_sock_open(spi, sn, W5500_MR_TCP, srcPort, W5500_SR_INIT)) {
+        return false;
+    }
+
+    port[0] = (dstPort >> 8) & 0xFF;
+    port[1] = dstPort & 0xFF;
+    w5500_write_sreg(spi, sn, W5500_Sn_DIPR, dstIP, 4);
+    w5500_write_sreg(spi, sn, W5500_Sn_DPORT, port, 2);
+
+    sockState[sn] = W5500_SOCK_CONNECTING;
+    rttStartUs[sn] = w5500_sock_nowUs();
+    if (!w5500_sock_cmd(spi, sn, W5500_CR_CONNECT)) {
+        sockState[sn] = W5500_SOCK_CLOSED;
+        return false;
+    }
+
+    return true;
+}
+
+bool w5500_sock_listen(SPI_Handle spi, uint8_t sn, uint16_t port)
+{
+    if (!w5500_sock_open(spi, sn, W5500_MR_TCP, port, W5500_SR_INIT)) {
+        return false;
+    }
+
+    sockState[sn] = W5500_SOCK_LISTENING;
+    if (!w5500_sock_cmd(spi, sn, W5500_CR_LISTEN)) {
+        sockState[sn] = W5500_SOCK_CLOSED;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ *  ======== w5500_sock_read16 ========
+ *  Read a 16-bit socket register the chip may update mid-read (Sn_TX_FSR,
+ *  Sn_RX_RSR): repeat until two reads agree.
+ */
+static bool w5500_sock_read16(SPI_Handle spi, uint8_t sn, uint8_t reg, uint16_t *val)
+{
+    uint8_t buf[2];
+    uint16_t prev;
+    int i;
+
+    if (!w5500_read_sreg(spi, sn, reg, buf, 2)) {
+        return false;
+    }
+    prev = (buf[0] << 8) | buf[1];
+
+    for (i = 0; i < W5500_CR_SPIN_MAX; i++) {
+        if (!w5500_read_sreg(spi, sn, reg, buf, 2)) {
+            return false;
+        }
+        *val = (buf[0] << 8) | buf[1];
+        if (*val == prev) {
+            return true;
+        }
+        prev = *val;
+    }
+    return false;
+}
+
+bool w5500_sock_put(SPI_Handle spi, uint8_t sn, const uint8_t *data, uint16_t len)
+{
+    uint8_t ptrBuf[2];
+
+    if (sn >= W5500_MAX_SOCK) {
+        return false;
+    }
+
+    // Pick up the SEND_OK of the previous message if it has arrived
+    if (sockState[sn] == W5500_SOCK_SENDING) {
+        w5500_sock_poll(spi);
+    }
+    if (sockState[sn] != W5500_SOCK_READY && sockState[sn] != W5500_SOCK_CLOSE_WAIT) {
+        txStaged[sn] = 0;
+        return false;
+    }
+
+    if (txStaged[sn] == 0) {
+        // First piece of a message: fetch the chip's write pointer and room
+        if (!w5500_read_sreg(spi, sn, W5500_Sn_TX_WR, ptrBuf, 2) ||
+            !w5500_sock_read16(spi, sn, W5500_Sn_TX_FSR, &txFree[sn])) {
+            return false;
+        }
+        txWr[sn] = (ptrBuf[0] << 8) | ptrBuf[1];
+    }
+
+    if (len > txFree[sn] - txStaged[sn] ||
+        !w5500_write_tx(spi, sn, txWr[sn] + txStaged[sn], data, len)) {
+        txStaged[sn] = 0;
+        return false;
+    }
+
+    txStaged[sn] += len;
+    return true;
+}
+
+bool w5500_sock_commit(SPI_Handle spi, uint8_t sn, const uint8_t dstIP[4], uint16_t dstPort)
+{
+    uint8_t ptrBuf[2];
+    uint16_t ptr;
+
+    if (sn >= W5500_MAX_SOCK || txStaged[sn] == 0 ||
+        (sockState[sn] != W5500_SOCK_READY && sockState[sn] != W5500_SOCK_CLOSE_WAIT)) {
+        return false;
+    }
+
+    // A multicast socket always sends to the group written at open
+    if ((sockMode[sn] & 0x0F) == W5500_MR_UDP && !(sockMode[sn] & W5500_MR_MULTI)) {
+        ptrBuf[0] = (dstPort >> 8) & 0xFF;
+        ptrBuf[1] = dstPort & 0xFF;
+        w5500_write_sreg(spi, sn, W5500_Sn_DIPR, dstIP, 4);
+        w5500_write_sreg(spi, sn, W5500_Sn_DPORT, ptrBuf, 2);
+    }
+
+    ptr = txWr[sn] + txStaged[sn];
+    txStaged[sn] = 0;
+
+    ptrBuf[0] = (ptr >> 8) & 0xFF;
+    ptrBuf[1] = ptr & 0xFF;
+    w5500_write_sreg(spi, sn, W5500_Sn_TX_WR, ptrBuf, 2);
+
+    sockState[sn] = W5500_SOCK_SENDING;
+    rttStartUs[sn] = w5500_sock_nowUs();
+    if (!w5500_sock_cmd(spi, sn, W5500_CR_SEND)) {
+        sockState[sn] = w5500_sock_idle(sn);
+        return false;
+    }
+
+    return true;
+}
+
+bool w5500_sock_send(SPI_Handle spi, uint8_t sn, const uint8_t *data, uint16_t len)
+{
+    if (sn >= W5500_MAX_SOCK || (sockMode[sn] & 0x0F) != W5500_MR_TCP ||
+        (sockState[sn] != W5500_SOCK_READY && sockState[sn] != W5500_SOCK_CLOSE_WAIT)) {
+        return false;
+    }
+
+    return w5500_sock_put(spi, sn, data, len) && w5500_sock_commit(spi, sn, NULL, 0);
+}
+
+bool w5500_sock_udp_open(SPI_Handle spi, uint8_t sn, uint16_t port, const uint8_t groupIP[4])
+{
+    uint8_t mode = W5500_MR_UDP;
+    uint8_t mac[6];
+    uint8_t portBuf[2];
+
+    if (sn >= W5500_MAX_SOCK) {
+        return false;
+    }
+
+    if (groupIP != NULL) {
+        // The group must be in place before OPEN; IGMP join is sent by the chip
+        mac[0] = 0x01;
+        mac[1] = 0x00;
+        mac[2] = 0x5E;
+        mac[3] = groupIP[1] & 0x7F;
+        mac[4] = groupIP[2];
+        mac[5] = groupIP[3];
+        portBuf[0] = (port >> 8) & 0xFF;
+        portBuf[1] = port & 0xFF;
+        w5500_write_sreg(spi, sn, W5500_Sn_DHAR, mac, 6);
+        w5500_write_sreg(spi, sn, W5500_Sn_DIPR, groupIP, 4);
+        w5500_write_sreg(spi, sn, W5500_Sn_DPORT, portBuf, 2);
+        mode |= W5500_MR_MULTI;
+    }
+
+    if (!w5500_sock_open(spi, sn, mode, port, W5500_SR_UDP)) {
+        return false;
+    }
+
+    sockState[sn] = W5500_SOCK_READY;
+    return true;
+}
+
+bool w5500_sock_macraw_open(SPI_Handle spi, uint8_t opts)
+{
+    if (!w5500_sock_open(spi, 0, W5500_MR_MACRAW | (opts & 0xF0), 0, W5500_SR_MACRAW)) {
+        return false;
+    }
+
+    sockState[0] = W5500_SOCK_READY;
+    return true;
+}
+
+bool w5500_sock_sendto(SPI_Handle spi, uint8_t sn, const uint8_t *data, uint16_t len,
+                       const uint8_t dstIP[4], uint16_t dstPort)
+{
+    if (sn >= W5500_MAX_SOCK || (sockMode[sn] & 0x0F) != W5500_MR_UDP) {
+        return false;
+    }
+
+    return w5500_sock_put(spi, sn, data, len) && w5500_sock_commit(spi, sn, dstIP, dstPort);
+}
+
+uint16_t w5500_sock_peek(SPI_Handle spi, uint8_t sn, uint8_t *buf, uint16_t maxLen)
+{
+    uint8_t ptrBuf[2];
+    uint16_t avail;
+
+    if (sn >= W5500_MAX_SOCK || maxLen == 0) {
+        return 0;
+    }
+
+    if (!w5500_sock_read16(spi, sn, W5500_Sn_RX_RSR, &avail) || avail == 0) {
+        return 0;
+    }
+    if (avail > maxLen) {
+        avail = maxLen;
+    }
+
+    if (!w5500_read_sreg(spi, sn, W5500_Sn_RX_RD, ptrBuf, 2)) {
+        return 0;
+    }
+    rxRd[sn] = (ptrBuf[0] << 8) | ptrBuf[1];
+
+    // Everything available in one burst (two if it wraps the ring)
+    if (!w5500_read_rx(spi, sn, rxRd[sn], buf, avail)) {
+        return 0;
+    }
+
+    return avail;
+}
+
+bool w5500_sock_consume(SPI_Handle spi, uint8_t sn, uint16_t len)
+{
+    uint8_t ptrBuf[2];
+
+    if (sn >= W5500_MAX_SOCK) {
+        return false;
+    }
+    if (len == 0) {
+        return true;
+    }
+
+    rxRd[sn] += len;
+    ptrBuf[0] = (rxRd[sn] >> 8) & 0xFF;
+    ptrBuf[1] = rxRd[sn] & 0xFF;
+    w5500_write_sreg(spi, sn, W5500_Sn_RX_RD, ptrBuf, 2);
+
+    // RECV hands the space back to the chip; RECV interrupts again if more is left
+    return w5500_sock_cmd(spi, sn, W5500_CR_RECV);
+}
+
+uint16_t w5500_sock_recv(SPI_Handle spi, uint8_t sn, uint8_t *buf, uint16_t maxLen)
+{
+    uint16_t n = w5500_sock_peek(spi, sn, buf, maxLen);
+
+    return (n > 0 && w5500_sock_consume(spi, sn, n)) ? n : 0;
+}
+
+bool w5500_sock_close(SPI_Handle spi, uint8_t sn)
+{
+    if (sn >= W5500_MAX_SOCK) {
+        return false;
+    }
+
+    sockState[sn] = W5500_SOCK_CLOSED;
+    return w5500_sock_cmd(spi, sn, W5500_CR_CLOSE);
+}
+
+bool w5500_sock_disconnect(SPI_Handle spi, uint8_t sn)
+{
+    if (sn >= W5500_MAX_SOCK || (sockMode[sn] & 0x0F) != W5500_MR_TCP) {
+        return false;
+    }
+
+    // The chip sends FIN and reaches SOCK_CLOSED by itself, raising DISCON
+    sockState[sn] = W5500_SOCK_CLOSED;
+    return w5500_sock_cmd(spi, sn, W5500_CR_DISCON);
+}
+
+W5500_SockState w5500_sock_state(uint8_t sn)
+{
+    return (sn < W5500_MAX_SOCK) ? sockState[sn] : W5500_SOCK_CLOSED;
+}
+
+uint8_t w5500_sock_events(uint8_t sn)
+{
+    uint8_t ir;
+
+    if (sn >= W5500_MAX_SOCK) {
+        return 0;
+    }
+
+    ir = pendingIr[sn];
+    pendingIr[sn] = 0;
+    return ir;
+}
+
+bool w5500_sock_wait(SPI_Handle spi, W5500_Event *evt, uint32_t timeoutMs)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += timeoutMs / 1000;
+    ts.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    while (xQueueReceive(evtQueue, evt, 0) != pdTRUE) {
+        if (sem_timedwait(&intSem, &ts) != 0) {
+            return false;
+        }
+        w5500_sock_service(spi);
+    }
+
+    return true;
+}
+
+bool w5500_sock_take_rtt(uint8_t sn, uint32_t *rtt)
+{
+    if (sn >= W5500_MAX_SOCK || !rttNew[sn]) {
+        return false;
+    }
+
+    rttNew[sn] = false;
+    *rtt = rttUs[sn];
+    return true;
+}
+
+void w5500_sock_set_notify(W5500_NotifyFxn fxn)
+{
+    notifyFxn = fxn;
+}
+
+void w5500_sock_poll(SPI_Handle spi)
+{
+    while (sem_trywait(&intSem) == 0) {
+        w5500_sock_service(spi);
+    }
+}
+
+W5500_SockState w5500_sock_settle(SPI_Handle spi, uint8_t sn, uint32_t timeoutMs)
+{
+    W5500_Event evt;
+
+    if (sn >= W5500_MAX_SOCK) {
+        return W5500_SOCK_CLOSED;
+    }
+
+    // Events for other sockets also wake us; their state is already applied
+    while (sockState[sn] == W5500_SOCK_CONNECTING || sockState[sn] == W5500_SOCK_SENDING) {
+        if (!w5500_sock_wait(spi, &evt, timeoutMs)) {
+            break;
+        }
+    }
+
+    return sockState[sn];
+}
@@ -0,0 +1,194 @@
+/*
+ *  ======== w5500_socket.h ========
+ *  Interrupt-driven socket engine for the eight W5500 hardware sockets.
+ *
+ *  The W5500 INTn pin drives a GPIO interrupt that only posts a semaphore.
+ *  The thread calling w5500_sock_wait() sleeps on it, then reads SIR/Sn_IR
+ *  over SPI, clears them, advances each socket's state machine and queues a
+ *  W5500_Event per interrupt. Nothing polls Sn_SR while an operation is in
+ *  flight, so the core can drop to standby between events.
+ */
+#ifndef W5500_SOCKET_H_
+#define W5500_SOCKET_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ti/drivers/SPI.h>
+
+#include "ti_drivers_config.h"
+
+/* GPIO wired to the W5500 INTn output (active low) */
+#ifndef W5500_INT_GPIO
+#define W5500_INT_GPIO CONFIG_SPI_PERIPHERAL_READY
+#endif
+
+typedef enum
+{
+    W5500_SOCK_CLOSED,
+    W5500_SOCK_LISTENING,  /* TCP server waiting for a peer */
+    W5500_SOCK_CONNECTING,
+    W5500_SOCK_READY,      /* ESTABLISHED (or UDP open), no SEND outstanding */
+    W5500_SOCK_SENDING,    /* SEND issued, waiting for SEND_OK */
+    W5500_SOCK_CLOSE_WAIT  /* TCP peer sent FIN; RX still readable, SEND allowed */
+} W5500_SockState;
+
+/* Called from the INTn interrupt, see w5500_sock_set_notify() */
+typedef void (*W5500_NotifyFxn)(void);
+
+typedef struct
+{
+    uint8_t sock;   /* socket number */
+    uint8_t ir;     /* Sn_IR bits that fired (W5500_IR_xxx) */
+} W5500_Event;
+
+/*
+ *  ======== w5500_sock_init ========
+ *  Set up the INTn GPIO interrupt, the event queue and the W5500 interrupt
+ *  masks for all sockets. Safe to call again after the SPI handle has been
+ *  reopened.
+ */
+bool w5500_sock_init(SPI_Handle spi);
+
+/*
+ *  ======== w5500_sock_connect ========
+ *  Open socket sn in TCP mode and issue CONNECT without waiting for the
+ *  handshake. The state moves to W5500_SOCK_READY on the CON interrupt.
+ */
+bool w5500_sock_connect(SPI_Handle spi, uint8_t sn, uint16_t srcPort,
+                        const uint8_t dstIP[4], uint16_t dstPort);
+
+/*
+ *  ======== w5500_sock_listen ========
+ *  Open socket sn as a TCP server on port. The state moves to
+ *  W5500_SOCK_READY on the CON interrupt when a peer connects.
+ */
+bool w5500_sock_listen(SPI_Handle spi, uint8_t sn, uint16_t port);
+
+/*
+ *  ======== w5500_sock_put ========
+ *  Burst len bytes into the TX buffer of socket sn behind anything already
+ *  put, without sending. Lets a message be gathered from several buffers
+ *  straight into the chip. Fails, dropping what was put, if the socket is
+ *  not W5500_SOCK_READY or W5500_SOCK_CLOSE_WAIT, or the message outgrows
+ *  Sn_TX_FSR.
+ */
+bool w5500_sock_put(SPI_Handle spi, uint8_t sn, const uint8_t *data, uint16_t len);
+
+/*
+ *  ======== w5500_sock_commit ========
+ *  Issue SEND for everything put since the last commit, as one TCP
+ *  segment run or one UDP datagram to dstIP:dstPort (ignored for TCP and
+ *  multicast sockets). Does not wait for SEND_OK.
+ */
+bool w5500_sock_commit(SPI_Handle spi, uint8_t sn, const uint8_t dstIP[4], uint16_t dstPort);
+
+/*
+ *  ======== w5500_sock_send ========
+ *  Put len bytes and commit them on TCP socket sn. Only valid in
+ *  W5500_SOCK_READY or W5500_SOCK_CLOSE_WAIT; the state returns there on
+ *  SEND_OK.
+ */
+bool w5500_sock_send(SPI_Handle spi, uint8_t sn, const uint8_t *data, uint16_t len);
+
+/*
+ *  ======== w5500_sock_udp_open ========
+ *  Open socket sn in UDP mode on port; it is W5500_SOCK_READY straight
+ *  away. With groupIP set the socket joins that multicast group and every
+ *  datagram goes to it.
+ */
+bool w5500_sock_udp_open(SPI_Handle spi, uint8_t sn, uint16_t port, const uint8_t groupIP[4]);
+
+/*
+ *  ======== w5500_sock_macraw_open ========
+ *  Open socket 0 in MACRAW mode with W5500_MR_MFEN/BCASTB/MMB/MIP6B opts.
+ *  Frames go out with w5500_sock_put() + w5500_sock_commit(); see
+ *  w5500_macraw.h for the receive side.
+ */
+bool w5500_sock_macraw_open(SPI_Handle spi, uint8_t opts);
+
+/*
+ *  ======== w5500_sock_sendto ========
+ *  Burst one datagram into the TX buffer of UDP socket sn and issue SEND,
+ *  without waiting for SEND_OK. Returns false while the previous datagram
+ *  is still going out.
+ */
+bool w5500_sock_sendto(SPI_Handle spi, uint8_t sn, const uint8_t *data, uint16_t len,
+                       const uint8_t dstIP[4], uint16_t dstPort);
+
+/*
+ *  ======== w5500_sock_recv ========
+ *  Read up to maxLen received bytes of socket sn into buf in one burst,
+ *  advance Sn_RX_RD and issue RECV. Returns the byte count, 0 if nothing
+ *  was waiting. On a UDP socket each datagram keeps its 8-byte header.
+ */
+uint16_t w5500_sock_recv(SPI_Handle spi, uint8_t sn, uint8_t *buf, uint16_t maxLen);
+
+/*
+ *  ======== w5500_sock_peek ========
+ *  As w5500_sock_recv() but leaves the data in the chip until
+ *  w5500_sock_consume(), for callers that can only take whole records.
+ */
+uint16_t w5500_sock_peek(SPI_Handle spi, uint8_t sn, uint8_t *buf, uint16_t maxLen);
+
+/*
+ *  ======== w5500_sock_consume ========
+ *  Free the first len bytes returned by the last w5500_sock_peek() on
+ *  socket sn: advance Sn_RX_RD and issue RECV.
+ */
+bool w5500_sock_consume(SPI_Handle spi, uint8_t sn, uint16_t len);
+
+bool w5500_sock_close(SPI_Handle spi, uint8_t sn);
+
+/*
+ *  ======== w5500_sock_disconnect ========
+ *  Issue DISCON on TCP socket sn: send FIN rather than dropping the session.
+ *  The answer to W5500_SOCK_CLOSE_WAIT once the received data is handled.
+ *  The state is W5500_SOCK_CLOSED straight away.
+ */
+bool w5500_sock_disconnect(SPI_Handle spi, uint8_t sn);
+
+W5500_SockState w5500_sock_state(uint8_t sn);
+
+/*
+ *  ======== w5500_sock_events ========
+ *  Return and clear the Sn_IR bits accumulated for socket sn since the last
+ *  call. Lets each service see its own events whichever thread slept.
+ */
+uint8_t w5500_sock_events(uint8_t sn);
+
+/*
+ *  ======== w5500_sock_wait ========
+ *  Sleep until the W5500 raises an interrupt or timeoutMs elapses. Returns
+ *  true with the next queued event, false on timeout.
+ */
+bool w5500_sock_wait(SPI_Handle spi, W5500_Event *evt, uint32_t timeoutMs);
+
+/*
+ *  ======== w5500_sock_take_rtt ========
+ *  Return the newest round trip measured on TCP socket sn, in us, from
+ *  CONNECT to CON or SEND to SEND_OK. False if none since the last call.
+ */
+bool w5500_sock_take_rtt(uint8_t sn, uint32_t *rttUs);
+
+/*
+ *  ======== w5500_sock_set_notify ========
+ *  Also call fxn from the INTn interrupt, for a thread that sleeps on
+ *  something other than w5500_sock_wait() and must be woken to poll.
+ */
+void w5500_sock_set_notify(W5500_NotifyFxn fxn);
+
+/*
+ *  ======== w5500_sock_poll ========
+ *  Service interrupts that fired since the last wait, without sleeping.
+ */
+void w5500_sock_poll(SPI_Handle spi);
+
+/*
+ *  ======== w5500_sock_settle ========
+ *  Consume events until socket sn leaves CONNECTING/SENDING or no event
+ *  arrives within timeoutMs. Returns the resulting state.
+ */
+W5500_SockState w5500_sock_settle(SPI_Handle spi, uint8_t sn, uint32_t timeoutMs);
+
+#endif /* W5500_SOCKET_H_ */
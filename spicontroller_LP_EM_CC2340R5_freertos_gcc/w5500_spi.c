@@ -0,0 +1,234 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* POSIX Header files */
+#include <semaphore.h>
+
+/* Driver Header files */
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/SPI.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+/* Driver configuration */
+#include "ti_drivers_config.h"
+
+#include "spi_bus.h"
+#include "w5500.h"
+#include "w5500_spi.h"
+
+#define W5500_SPI_NUM_FRAMES (2)
+#define W5500_SPI_FRAME_MAX  (W5500_FRAME_HDR_LEN + W5500_SPI_CHUNK)
+
+/* RWB bit of the control byte */
+#define W5500_CTRL_WRITE (0x04)
+
+#define W5500_FRAME_NONE (-1)
+
+typedef struct
+{
+    SPI_Transaction trans;
+    uint8_t buf[W5500_SPI_FRAME_MAX];
+    bool isRead;
+} W5500_SpiFrame;
+
+static W5500_SpiFrame frames[W5500_SPI_NUM_FRAMES];
+
+/* Reads complete one at a time, so they share one receive buffer */
+static uint8_t rxScratch[W5500_SPI_FRAME_MAX];
+
+/* Owned by the transfer callback once frames are queued */
+static volatile int8_t activeFrame = W5500_FRAME_NONE;
+static volatile int8_t queuedFrame = W5500_FRAME_NONE;
+static volatile bool readOk;
+static volatile bool spiErr;
+
+/* Frames complete in order, so buffers are filled strictly alternating */
+static uint8_t fillFrame = 0;
+
+static sem_t frameFreeSem;  /* counts buffers not on the wire or queued */
+static sem_t readDoneSem;
+static bool semsDone = false;
+
+static void w5500SpiCallback(SPI_Handle spi, SPI_Transaction *trans);
+
+/* Mode 3 and the bit rate are shared with the MAX31856 */
+static SpiBus_Device w5500Dev = {
+    .csGpio      = CONFIG_GPIO_SPI_CONTROLLER_CSN,
+    .frameFormat = SPI_POL1_PHA1,
+    .bitRate     = W5500_SPI_BITRATE,
+    .priority    = W5500_SPI_PRIORITY,
+    .callbackFxn = w5500SpiCallback,
+};
+
+static void w5500_spi_start(SPI_Handle spi, int8_t idx);
+
+/*
+ *  ======== w5500_spi_done ========
+ *  Retire frame idx and put the queued frame (if any) on the wire. Runs in
+ *  the transfer callback, or with interrupts disabled when a start fails.
+ */
+static void w5500_spi_done(SPI_Handle spi, int8_t idx, bool ok)
+{
+    int8_t next = queuedFrame;
+
+    activeFrame = W5500_FRAME_NONE;
+    queuedFrame = W5500_FRAME_NONE;
+
+    if (!ok) {
+        spiErr = true;
+    }
+    if (frames[idx].isRead) {
+        readOk = ok;
+        sem_post(&readDoneSem);
+    }
+    sem_post(&frameFreeSem);
+
+    if (next != W5500_FRAME_NONE) {
+        w5500_spi_start(spi, next);
+    } else {
+        // Pipeline drained, let the other devices in
+        spi_bus_release(&w5500Dev);
+    }
+}
+
+static void w5500_spi_start(SPI_Handle spi, int8_t idx)
+{
+    activeFrame = idx;
+
+    GPIO_write(w5500Dev.csGpio, 0);
+    if (!SPI_transfer(spi, &frames[idx].trans)) {
+        GPIO_write(w5500Dev.csGpio, 1);
+        w5500_spi_done(spi, idx, false);
+    }
+}
+
+/*
+ *  ======== w5500SpiCallback ========
+ *  SPI transfer callback: end the frame and chain the next one.
+ */
+static void w5500SpiCallback(SPI_Handle spi, SPI_Transaction *trans)
+{
+    GPIO_write(w5500Dev.csGpio, 1);
+    w5500_spi_done(spi, (int8_t)(uintptr_t)trans->arg,
+                   trans->status == SPI_TRANSFER_COMPLETED);
+}
+
+static void w5500_spi_submit(SPI_Handle spi, int8_t idx)
+{
+    uintptr_t key;
+
+    key = HwiP_disable();
+    if (activeFrame != W5500_FRAME_NONE) {
+        // Picked up by the callback of the frame on the wire
+        queuedFrame = idx;
+        HwiP_restore(key);
+        return;
+    }
+    HwiP_restore(key);
+
+    // Pipeline idle: the bus was released with the last frame. Only this
+    // thread submits, so it stays idle until we start it below.
+    if (!spi_bus_acquire(&w5500Dev)) {
+        // No usable controller: fail the frame like a transfer error
+        key = HwiP_disable();
+        w5500_spi_done(spi, idx, false);
+        HwiP_restore(key);
+        return;
+    }
+
+    key = HwiP_disable();
+    w5500_spi_start(spi, idx);
+    HwiP_restore(key);
+}
+
+SPI_Handle w5500_spi_open(uint_least8_t index, uint32_t bitRate)
+{
+    int i;
+
+    if (!semsDone) {
+        if (sem_init(&frameFreeSem, 0, W5500_SPI_NUM_FRAMES) != 0 ||
+            sem_init(&readDoneSem, 0, 0) != 0) {
+            return NULL;
+        }
+        semsDone = true;
+    }
+
+    for (i = 0; i < W5500_SPI_NUM_FRAMES; i++) {
+        frames[i].trans.arg = (void *)(uintptr_t)i;
+    }
+
+    GPIO_write(w5500Dev.csGpio, 1);
+
+    w5500Dev.bitRate = bitRate;
+    return spi_bus_open(index, &w5500Dev);
+}
+
+bool w5500_spi_frame(SPI_Handle spi, uint8_t ctrl, uint16_t offset,
+                     const uint8_t *txData, uint8_t *rxData, uint16_t len)
+{
+    W5500_SpiFrame *f;
+    bool isRead = !(ctrl & W5500_CTRL_WRITE);
+    uint16_t n;
+    bool ok;
+
+    do {
+        n = (len > W5500_SPI_CHUNK) ? W5500_SPI_CHUNK : len;
+
+        // Blocks only while both buffers are on the wire or queued
+        sem_wait(&frameFreeSem);
+        f = &frames[fillFrame];
+        fillFrame ^= 1;
+
+        f->buf[0] = (offset >> 8) & 0xFF;
+        f->buf[1] = offset & 0xFF;
+        f->buf[2] = ctrl;
+        if (!isRead) {
+            memcpy(&f->buf[W5500_FRAME_HDR_LEN], txData, n);
+        }
+
+        f->isRead      = isRead;
+        f->trans.count = W5500_FRAME_HDR_LEN + n;
+        f->trans.txBuf = f->buf;
+        f->trans.rxBuf = isRead ? rxScratch : NULL;
+
+        w5500_spi_submit(spi, (int8_t)(f - frames));
+
+        if (isRead) {
+            sem_wait(&readDoneSem);
+
+            // Failed writes queued earlier are reported here
+            ok = readOk && !spiErr;
+            spiErr = false;
+            if (!ok) {
+                return false;
+            }
+            memcpy(rxData, &rxScratch[W5500_FRAME_HDR_LEN], n);
+            rxData += n;
+        } else {
+            txData += n;
+        }
+
+        offset += n;
+        len -= n;
+    } while (len > 0);
+
+    return true;
+}
+
+bool w5500_spi_flush(void)
+{
+    bool ok;
+    int i;
+
+    for (i = 0; i < W5500_SPI_NUM_FRAMES; i++) {
+        sem_wait(&frameFreeSem);
+    }
+    for (i = 0; i < W5500_SPI_NUM_FRAMES; i++) {
+        sem_post(&frameFreeSem);
+    }
+
+    ok = !spiErr;
+    spiErr = false;
+    return ok;
+}
@@ -0,0 +1,68 @@
+/*
+ *  ======== w5500_spi.h ========
+ *  Double-buffered SPI transfer layer for the W5500.
+ *
+ *  The controller is opened in SPI_MODE_CALLBACK. Each W5500 frame (header
+ *  plus payload) is assembled into one of two frame buffers and clocked out
+ *  as a single DMA transaction. While one buffer is on the wire the caller
+ *  fills the other; the transfer callback raises CS, then lowers it and
+ *  starts the queued buffer straight away, so back-to-back frames leave no
+ *  task-level gap on the bus.
+ *
+ *  The controller is shared through spi_bus: the W5500 takes the bus when
+ *  its pipeline starts and releases it from the callback once the last
+ *  queued frame is out, so other devices get in between bursts.
+ *
+ *  Writes return once the frame is queued. Reads queue behind any pending
+ *  writes and block until their own frame completes, so access order is
+ *  the call order. Only one thread may drive the W5500 at a time.
+ */
+#ifndef W5500_SPI_H_
+#define W5500_SPI_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ti/drivers/SPI.h>
+
+#include "spi_bus.h"
+
+/* W5500 SCLK; the chip is specified to 33 MHz, the LaunchPad wiring to 10.
+ * It shares the bus rate with the MAX31856 so hand-overs stay cheap. */
+#ifndef W5500_SPI_BITRATE
+#define W5500_SPI_BITRATE (SPI_BUS_BITRATE)
+#endif
+
+/* Bus priority against the other spi_bus devices */
+#ifndef W5500_SPI_PRIORITY
+#define W5500_SPI_PRIORITY (1)
+#endif
+
+/* Payload bytes per frame buffer; longer accesses are split into frames */
+#define W5500_SPI_CHUNK (512)
+
+/*
+ *  ======== w5500_spi_open ========
+ *  Open the shared bus on SPI instance index, configured for the W5500.
+ *  Call once before any task uses the bus. Returns NULL on failure.
+ */
+SPI_Handle w5500_spi_open(uint_least8_t index, uint32_t bitRate);
+
+/*
+ *  ======== w5500_spi_frame ========
+ *  Run one W5500 access of len bytes at offset; ctrl is the frame control
+ *  byte and its RWB bit picks the direction. A write copies txData into a
+ *  frame buffer and returns without waiting; a read waits and copies the
+ *  payload to rxData.
+ */
+bool w5500_spi_frame(SPI_Handle spi, uint8_t ctrl, uint16_t offset,
+                     const uint8_t *txData, uint8_t *rxData, uint16_t len);
+
+/*
+ *  ======== w5500_spi_flush ========
+ *  Wait until every queued frame has been clocked out. Returns false if any
+ *  transfer failed since the last flush.
+ */
+bool w5500_spi_flush(void);
+
+#endif /* W5500_SPI_H_ */
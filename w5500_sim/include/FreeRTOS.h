@@ -0,0 +1,22 @@
+/*
+ *  ======== FreeRTOS.h ========
+ *  Host shim: the types and constants the W5500 driver uses.
+ */
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdFALSE (0)
+#define pdTRUE  (1)
+#define pdPASS  (pdTRUE)
+#define pdFAIL  (pdFALSE)
+
+#define portMAX_DELAY    ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(x) ((TickType_t)(x))
+
+#endif /* INC_FREERTOS_H */
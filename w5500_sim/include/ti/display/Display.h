@@ -0,0 +1,18 @@
+/*
+ *  ======== Display.h ========
+ *  Host shim: Display_printf() goes to stdout.
+ */
+#ifndef ti_display_Display__include
+#define ti_display_Display__include
+
+#include <stdint.h>
+
+typedef struct Display_Config *Display_Handle;
+
+#define Display_Type_UART (0x20)
+
+void Display_init(void);
+Display_Handle Display_open(uint32_t id, void *params);
+void Display_printf(Display_Handle handle, uint8_t line, uint8_t column, const char *fmt, ...);
+
+#endif /* ti_display_Display__include */
@@ -0,0 +1,37 @@
+/*
+ *  ======== GPIO.h ========
+ *  Host shim of the TI GPIO driver API. Writes to the W5500 CS pin frame
+ *  the model's SPI transactions; the W5500 INTn pin calls back on a
+ *  falling edge.
+ */
+#ifndef ti_drivers_GPIO__include
+#define ti_drivers_GPIO__include
+
+#include <stdint.h>
+
+typedef uint32_t GPIO_PinConfig;
+typedef void (*GPIO_CallbackFxn)(uint_least8_t index);
+
+#define GPIO_CFG_OUT_STD        (0x0001)
+#define GPIO_CFG_OUT_LOW        (0x0002)
+#define GPIO_CFG_OUT_HIGH       (0x0004)
+#define GPIO_CFG_IN_NOPULL      (0x0008)
+#define GPIO_CFG_IN_PU          (0x0010)
+#define GPIO_CFG_IN_PD          (0x0020)
+#define GPIO_CFG_IN_INT_NONE    (0x0000)
+#define GPIO_CFG_IN_INT_FALLING (0x0100)
+#define GPIO_CFG_IN_INT_RISING  (0x0200)
+
+#define GPIO_INVALID_INDEX (0xFF)
+
+void GPIO_init(void);
+int_fast16_t GPIO_setConfig(uint_least8_t index, GPIO_PinConfig pinConfig);
+void GPIO_setCallback(uint_least8_t index, GPIO_CallbackFxn callback);
+void GPIO_enableInt(uint_least8_t index);
+void GPIO_disableInt(uint_least8_t index);
+void GPIO_clearInt(uint_least8_t index);
+void GPIO_write(uint_least8_t index, unsigned int value);
+uint_fast8_t GPIO_read(uint_least8_t index);
+void GPIO_toggle(uint_least8_t index);
+
+#endif /* ti_drivers_GPIO__include */
@@ -0,0 +1,81 @@
+/*
+ *  ======== SPI.h ========
+ *  Host shim of the TI SPI driver API used by the W5500 driver. Transfers
+ *  are clocked into the W5500 model by w5500_sim_shim.c.
+ */
+#ifndef ti_drivers_SPI__include
+#define ti_drivers_SPI__include
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct SPI_Config_ *SPI_Handle;
+
+typedef enum
+{
+    SPI_TRANSFER_COMPLETED = 0,
+    SPI_TRANSFER_STARTED,
+    SPI_TRANSFER_QUEUED,
+    SPI_TRANSFER_FAILED,
+    SPI_TRANSFER_CSN_DEASSERT,
+    SPI_TRANSFER_PEND_CSN_ASSERT,
+    SPI_TRANSFER_CANCELED
+} SPI_Status;
+
+typedef enum
+{
+    SPI_POL0_PHA0 = 0,
+    SPI_POL0_PHA1 = 1,
+    SPI_POL1_PHA0 = 2,
+    SPI_POL1_PHA1 = 3,
+    SPI_TI        = 4,
+    SPI_MW        = 5
+} SPI_FrameFormat;
+
+typedef enum
+{
+    SPI_MODE_BLOCKING,
+    SPI_MODE_CALLBACK
+} SPI_TransferMode;
+
+typedef enum
+{
+    SPI_CONTROLLER = 0,
+    SPI_PERIPHERAL = 1
+} SPI_Mode;
+
+typedef struct
+{
+    size_t count;
+    void *txBuf;
+    void *rxBuf;
+    void *arg;
+    volatile SPI_Status status;
+    void *nextPtr;
+} SPI_Transaction;
+
+typedef void (*SPI_CallbackFxn)(SPI_Handle handle, SPI_Transaction *transaction);
+
+typedef struct
+{
+    SPI_TransferMode transferMode;
+    uint32_t transferTimeout;
+    SPI_CallbackFxn transferCallbackFxn;
+    SPI_Mode mode;
+    uint32_t bitRate;
+    uint32_t dataSize;
+    SPI_FrameFormat frameFormat;
+    void *custom;
+} SPI_Params;
+
+#define SPI_WAIT_FOREVER (~(0U))
+
+void SPI_init(void);
+void SPI_Params_init(SPI_Params *params);
+SPI_Handle SPI_open(uint_least8_t index, SPI_Params *params);
+void SPI_close(SPI_Handle handle);
+bool SPI_transfer(SPI_Handle handle, SPI_Transaction *transaction);
+void SPI_transferCancel(SPI_Handle handle);
+
+#endif /* ti_drivers_SPI__include */
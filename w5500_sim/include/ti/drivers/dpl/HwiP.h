@@ -0,0 +1,14 @@
+/*
+ *  ======== HwiP.h ========
+ *  Host shim: "interrupts disabled" is one recursive mutex that the SPI
+ *  completion and GPIO callbacks also run under.
+ */
+#ifndef ti_dpl_HwiP__include
+#define ti_dpl_HwiP__include
+
+#include <stdint.h>
+
+uintptr_t HwiP_disable(void);
+void HwiP_restore(uintptr_t key);
+
+#endif /* ti_dpl_HwiP__include */
@@ -0,0 +1,24 @@
+/*
+ *  ======== ti_drivers_config.h ========
+ *  Host stand-in for the SysConfig output of spicontroller.syscfg, with the
+ *  pin indices the W5500 driver refers to.
+ */
+#ifndef ti_drivers_config_h
+#define ti_drivers_config_h
+
+#define CONFIG_SPI_CONTROLLER 0
+
+#define CONFIG_GPIO_SPI_CONTROLLER_CSN 11
+#define CONFIG_SPI_CONTROLLER_READY    10
+#define CONFIG_SPI_PERIPHERAL_READY    8   /* W5500 INTn */
+#define CONFIG_GPIO_LED_0              14
+#define CONFIG_GPIO_LED_1              15
+#define CS2                            25
+#define CS3                            2
+#define CS4                            7
+#define CS5                            21
+
+#define CONFIG_GPIO_LED_ON  (1)
+#define CONFIG_GPIO_LED_OFF (0)
+
+#endif /* ti_drivers_config_h */
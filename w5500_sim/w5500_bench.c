@@ -0,0 +1,486 @@
+/*
+ *  ======== w5500_bench.c ========
+ *  Runs the firmware's W5500 driver (w5500.c, w5500_spi.c, spi_bus.c,
+ *  w5500_socket.c, w5500_conn.c, w5500_macraw.c, w5500_retry.c) against
+ *  the register-level model.
+ *
+ *    w5500_bench --check      framing/pointer regression checks, exit 1 on
+ *                             a failure
+ *    w5500_bench [count]      send-path throughput: count UDP datagrams
+ *                             (default 2000) of telemetry-sized batches
+ *
+ *  See README.md for the build command.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/SPI.h>
+
+#include "ti_drivers_config.h"
+
+#include "sample_ring.h"
+#include "telemetry.h"
+#include "w5500.h"
+#include "w5500_conn.h"
+#include "w5500_macraw.h"
+#include "w5500_retry.h"
+#include "w5500_socket.h"
+#include "w5500_spi.h"
+
+#include "w5500_sim.h"
+#include "w5500_sim_shim.h"
+
+#define SOCK_UDP (0)
+#define SOCK_TCP (1)
+
+#define UDP_PORT     (5000)
+#define UDP_DST_PORT (6001)
+#define TCP_PORT     (7000)
+
+/* A full sample ring, the largest datagram netDrainSamples() sends */
+#define BENCH_DATAGRAM_LEN (SAMPLE_RING_LEN * TELEM_FRAME_LEN)
+
+#define SETTLE_MS (1000)
+
+static const uint8_t sockTxKB[W5500_MAX_SOCK] = {8, 2, 2, 0, 0, 0, 0, 0};
+static const uint8_t sockRxKB[W5500_MAX_SOCK] = {2, 4, 2, 0, 0, 0, 0, 0};
+
+static const uint8_t dstIP[4]  = {192, 168, 1, 100};
+static const uint8_t peerIP[4] = {192, 168, 1, 7};
+
+static SPI_Handle spi;
+
+/* Last datagram the model sent */
+static uint8_t  sentData[W5500_SIM_MEM_SIZE];
+static uint16_t sentLen;
+static uint8_t  sentIP[4];
+static uint16_t sentPort;
+static uint8_t  sentMode;
+static uint32_t sentCount;
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                                       \
+    do {                                                       \
+        if (!(cond)) {                                         \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);        \
+            printf(__VA_ARGS__);                               \
+            printf(" [model: %s]\n", w5500_sim_last_error());  \
+            failures++;                                        \
+            return;                                            \
+        }                                                      \
+    } while (0)
+
+static void simTxFxn(const W5500Sim_Packet *pkt)
+{
+    memcpy(sentData, pkt->data, pkt->len);
+    sentLen  = pkt->len;
+    memcpy(sentIP, pkt->dstIP, 4);
+    sentPort = pkt->dstPort;
+    sentMode = pkt->mode;
+    sentCount++;
+}
+
+static void fill(uint8_t *buf, uint16_t len, uint32_t seed)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(seed * 131 + i * 7 + (i >> 8));
+    }
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static bool setup(void)
+{
+    W5500_ConnConfig cfg = {
+        .mac     = {0x00, 0x08, 0xDC, 0x11, 0x22, 0x33},
+        .ip      = {192, 168, 1, 50},
+        .subnet  = {255, 255, 255, 0},
+        .gateway = {192, 168, 1, 1},
+        .dstIP   = {192, 168, 1, 100},
+        .sock    = 2,
+        .srcPort = 5001,
+        .dstPort = 6000,
+        .eventTimeoutMs = SETTLE_MS,
+    };
+
+    w5500_sim_reset();
+    w5500_sim_set_tx_fxn(simTxFxn);
+
+    GPIO_init();
+    SPI_init();
+
+    spi = w5500_spi_open(CONFIG_SPI_CONTROLLER, W5500_SPI_BITRATE);
+    if (spi == NULL) {
+        printf("w5500_spi_open failed\n");
+        return false;
+    }
+
+    return w5500_set_buf_sizes(spi, sockTxKB, sockRxKB) && w5500_conn_init(spi, &cfg);
+}
+
+static void check_common(void)
+{
+    static const uint8_t mac[6] = {0x00, 0x08, 0xDC, 0x11, 0x22, 0x33};
+    uint8_t buf[6];
+    uint8_t kb;
+    uint8_t sn;
+
+    CHECK(w5500_read_reg(spi, W5500_VERSIONR, buf, 1) && buf[0] == W5500_SIM_VERSION,
+          "VERSIONR 0x%02x", buf[0]);
+    CHECK(w5500_read_reg(spi, W5500_SHAR, buf, 6) && memcmp(buf, mac, 6) == 0,
+          "SHAR not written");
+
+    for (sn = 0; sn < W5500_MAX_SOCK; sn++) {
+        CHECK(w5500_read_sreg(spi, sn, W5500_Sn_TXBUF_SIZE, &kb, 1) && kb == sockTxKB[sn],
+              "socket %u Sn_TXBUF_SIZE %u", sn, kb);
+        CHECK(w5500_read_sreg(spi, sn, W5500_Sn_RXBUF_SIZE, &kb, 1) && kb == sockRxKB[sn],
+              "socket %u Sn_RXBUF_SIZE %u", sn, kb);
+    }
+    printf("ok   common registers and buffer sizing\n");
+}
+
+/*
+ *  ======== check_udp_send ========
+ *  Odd-sized datagrams walk Sn_TX_WR round the 8 KB ring several times,
+ *  some gathered from two puts, and must arrive intact.
+ */
+static void check_udp_send(void)
+{
+    uint8_t data[1500];
+    uint16_t len;
+    uint16_t half;
+    uint32_t i;
+
+    CHECK(w5500_sock_udp_open(spi, SOCK_UDP, UDP_PORT, NULL), "UDP open");
+    CHECK(w5500_sim_status(SOCK_UDP) == W5500_SR_UDP, "Sn_SR 0x%02x", w5500_sim_status(SOCK_UDP));
+
+    for (i = 0; i < 64; i++) {
+        len = 1 + (i * 397) % sizeof(data);
+        fill(data, len, i);
+        sentCount = 0;
+
+        if (i % 2) {
+            half = len / 2;
+            CHECK(w5500_sock_put(spi, SOCK_UDP, data, half) &&
+                  w5500_sock_put(spi, SOCK_UDP, data + half, len - half) &&
+                  w5500_sock_commit(spi, SOCK_UDP, dstIP, UDP_DST_PORT),
+                  "datagram %u gathered send", i);
+        } else {
+            CHECK(w5500_sock_sendto(spi, SOCK_UDP, data, len, dstIP, UDP_DST_PORT),
+                  "datagram %u send", i);
+        }
+        CHECK(w5500_sock_settle(spi, SOCK_UDP, SETTLE_MS) == W5500_SOCK_READY,
+              "datagram %u: no SEND_OK", i);
+
+        CHECK(sentCount == 1 && sentLen == len && memcmp(sentData, data, len) == 0,
+              "datagram %u: sent %u bytes of %u", i, sentLen, len);
+        CHECK(memcmp(sentIP, dstIP, 4) == 0 && sentPort == UDP_DST_PORT,
+              "datagram %u: wrong destination", i);
+    }
+    printf("ok   UDP send across the TX ring wrap\n");
+}
+
+/*
+ *  ======== check_tcp_recv ========
+ *  A peer connects to the command socket and sends chunks that walk
+ *  Sn_RX_RD round the 4 KB ring; each comes back out of w5500_sock_recv().
+ */
+static void check_tcp_recv(void)
+{
+    uint8_t in[700];
+    uint8_t out[700];
+    uint16_t len;
+    uint16_t got;
+    uint16_t n;
+    uint32_t i;
+
+    CHECK(w5500_sock_listen(spi, SOCK_TCP, TCP_PORT), "listen");
+    w5500_spi_flush();  // LISTEN is a queued write, let it reach the model
+    CHECK(w5500_sim_status(SOCK_TCP) == W5500_SR_LISTEN, "Sn_SR 0x%02x", w5500_sim_status(SOCK_TCP));
+
+    CHECK(w5500_sim_peer_connect(SOCK_TCP), "peer connect");
+    w5500_sock_poll(spi);
+    CHECK(w5500_sock_state(SOCK_TCP) == W5500_SOCK_READY, "state %d after CON",
+          w5500_sock_state(SOCK_TCP));
+    CHECK(w5500_sock_events(SOCK_TCP) & W5500_IR_CON, "CON not reported");
+
+    for (i = 0; i < 40; i++) {
+        len = 1 + (i * 251) % sizeof(in);
+        fill(in, len, i + 1000);
+        CHECK(w5500_sim_peer_send(SOCK_TCP, peerIP, 40000, in, len), "peer send %u", i);
+
+        w5500_sock_poll(spi);
+        CHECK(w5500_sock_events(SOCK_TCP) & W5500_IR_RECV, "chunk %u: no RECV", i);
+
+        // 100-byte reads leave data behind each RECV
+        got = 0;
+        while (got < len) {
+            n = w5500_sock_recv(spi, SOCK_TCP, out + got, (len - got > 100) ? 100 : len - got);
+            CHECK(n > 0, "chunk %u: recv stalled at %u of %u", i, got, len);
+            got += n;
+        }
+        CHECK(memcmp(in, out, len) == 0, "chunk %u: data mismatch", i);
+        CHECK(w5500_sock_recv(spi, SOCK_TCP, out, sizeof(out)) == 0, "chunk %u: extra data", i);
+    }
+
+    // Replies on the same session
+    fill(in, 64, 7);
+    sentCount = 0;
+    CHECK(w5500_sock_send(spi, SOCK_TCP, in, 64) &&
+          w5500_sock_settle(spi, SOCK_TCP, SETTLE_MS) == W5500_SOCK_READY, "TCP send");
+    CHECK(sentCount == 1 && sentLen == 64 && memcmp(sentData, in, 64) == 0, "TCP payload");
+
+    // A request followed straight by FIN: still readable and answerable
+    fill(in, 48, 9);
+    CHECK(w5500_sim_peer_send(SOCK_TCP, peerIP, 40000, in, 48), "peer send before close");
+    CHECK(w5500_sim_peer_close(SOCK_TCP), "peer close");
+    w5500_sock_poll(spi);
+    CHECK(w5500_sock_state(SOCK_TCP) == W5500_SOCK_CLOSE_WAIT, "state %d after DISCON",
+          w5500_sock_state(SOCK_TCP));
+    CHECK(w5500_sock_recv(spi, SOCK_TCP, out, sizeof(out)) == 48 && memcmp(in, out, 48) == 0,
+          "data lost on DISCON");
+    sentCount = 0;
+    CHECK(w5500_sock_send(spi, SOCK_TCP, in, 16) &&
+          w5500_sock_settle(spi, SOCK_TCP, SETTLE_MS) == W5500_SOCK_CLOSE_WAIT,
+          "send in CLOSE_WAIT");
+    CHECK(sentCount == 1 && sentLen == 16, "CLOSE_WAIT payload");
+
+    CHECK(w5500_sock_disconnect(spi, SOCK_TCP), "disconnect");
+    w5500_spi_flush();
+    w5500_sock_poll(spi);
+    CHECK(w5500_sock_state(SOCK_TCP) == W5500_SOCK_CLOSED, "state %d after disconnect",
+          w5500_sock_state(SOCK_TCP));
+    CHECK(w5500_sim_status(SOCK_TCP) == W5500_SR_CLOSED, "Sn_SR 0x%02x after disconnect",
+          w5500_sim_status(SOCK_TCP));
+
+    printf("ok   TCP accept, receive across the RX ring wrap, send, peer close\n");
+}
+
+static void check_udp_recv(void)
+{
+    uint8_t in[200];
+    uint8_t out[sizeof(in) + 8];
+    uint16_t n;
+
+    fill(in, sizeof(in), 99);
+    CHECK(w5500_sim_peer_send(SOCK_UDP, peerIP, 40001, in, sizeof(in)), "peer datagram");
+    w5500_sock_poll(spi);
+
+    n = w5500_sock_recv(spi, SOCK_UDP, out, sizeof(out));
+    CHECK(n == sizeof(out), "recv %u bytes", n);
+    CHECK(memcmp(out, peerIP, 4) == 0 && ((out[4] << 8) | out[5]) == 40001 &&
+          ((out[6] << 8) | out[7]) == sizeof(in) && memcmp(&out[8], in, sizeof(in)) == 0,
+          "UDP header or payload");
+    printf("ok   UDP receive with the 8-byte header\n");
+}
+
+static uint8_t  rawFrames[2][W5500_MACRAW_FRAME_MAX];
+static uint16_t rawLens[2];
+static uint16_t rawCount;
+
+static void macrawFxn(const uint8_t *frame, uint16_t len, void *arg)
+{
+    (void)arg;
+
+    if (rawCount < 2) {
+        memcpy(rawFrames[rawCount], frame, len);
+        rawLens[rawCount] = len;
+    }
+    rawCount++;
+}
+
+/*
+ *  ======== check_macraw ========
+ *  Frames queued in socket 0's 2 KB RX buffer come out whole and in order
+ *  across the ring wrap; an injected frame goes out as is.
+ */
+static void check_macraw(void)
+{
+    static const uint16_t lens[] = {60, 342, 1514, 98, 1200, 14, 700, 700};
+    uint8_t frame[W5500_MACRAW_FRAME_MAX];
+    uint32_t i;
+    uint32_t j;
+    uint16_t n;
+
+    CHECK(w5500_macraw_open(spi, W5500_MR_MFEN), "MACRAW open");
+    CHECK(w5500_sim_status(W5500_MACRAW_SOCK) == W5500_SR_MACRAW, "Sn_SR 0x%02x",
+          w5500_sim_status(W5500_MACRAW_SOCK));
+
+    // Pairs that fit the buffer together, so each pair is one burst
+    for (i = 0; i < sizeof(lens) / sizeof(lens[0]); i += 2) {
+        rawCount = 0;
+        for (j = i; j < i + 2; j++) {
+            fill(frame, lens[j], j + 500);
+            CHECK(w5500_sim_peer_send(W5500_MACRAW_SOCK, peerIP, 0, frame, lens[j]),
+                  "peer frame %u", j);
+        }
+
+        w5500_sock_poll(spi);
+        n = w5500_macraw_poll(spi, macrawFxn, NULL);
+        CHECK(n == 2 && rawCount == 2, "frames %u/%u: %u delivered", i, i + 1, n);
+
+        for (j = 0; j < 2; j++) {
+            fill(frame, lens[i + j], i + j + 500);
+            CHECK(rawLens[j] == lens[i + j] && memcmp(rawFrames[j], frame, rawLens[j]) == 0,
+                  "frame %u: %u bytes, expected %u", i + j, rawLens[j], lens[i + j]);
+        }
+    }
+
+    fill(frame, 60, 77);
+    sentCount = 0;
+    CHECK(w5500_macraw_send(spi, frame, 60) &&
+          w5500_sock_settle(spi, W5500_MACRAW_SOCK, SETTLE_MS) == W5500_SOCK_READY, "inject");
+    CHECK(sentCount == 1 && sentMode == W5500_MR_MACRAW && sentLen == 60 &&
+          memcmp(sentData, frame, 60) == 0, "injected frame");
+    CHECK(w5500_macraw_stats()->rxBad == 0, "bad frame lengths");
+
+    printf("ok   MACRAW receive bursts across the RX ring wrap, inject\n");
+}
+
+/*
+ *  ======== check_retry ========
+ *  RTR/RCR and Sn_KPALVTR land in the chip, and adaptive mode settles on
+ *  the floor retry time (the model answers at once) with the window kept.
+ */
+static void check_retry(void)
+{
+    W5500_RetryConfig cfg = {
+        .rtoMinUs     = 10000,
+        .rtoMaxUs     = 1000000,
+        .failWindowMs = 3000,
+    };
+    const W5500_RetryStatus *st = w5500_retry_status();
+    uint8_t data[32];
+    uint8_t buf[2];
+    uint32_t i;
+
+    // Chip defaults, the datasheet's worked example: 9 attempts, doubling
+    // from 200 ms while the next step still fits 16 bits, 31.8 s in all
+    CHECK(w5500_retry_window_ms(200000, 8) == 200 + 400 + 800 + 1600 + 3200 + 4 * 6400,
+          "default window %u ms", w5500_retry_window_ms(200000, 8));
+
+    CHECK(w5500_retry_set(spi, 150000, 3) && w5500_read_reg(spi, W5500_RTR, buf, 2) &&
+          ((buf[0] << 8) | buf[1]) == 1500, "RTR 0x%02x%02x", buf[0], buf[1]);
+    CHECK(w5500_read_reg(spi, W5500_RCR, buf, 1) && buf[0] == 3, "RCR %u", buf[0]);
+
+    CHECK(w5500_retry_set_keepalive(spi, 2, 12) &&
+          w5500_read_sreg(spi, 2, W5500_Sn_KPALVTR, buf, 1) && buf[0] == 3,
+          "Sn_KPALVTR %u", buf[0]);
+
+    CHECK(w5500_retry_adaptive(spi, &cfg), "adaptive");
+    fill(data, sizeof(data), 3);
+    for (i = 0; i < 20; i++) {
+        CHECK(w5500_conn_send(spi, data, sizeof(data)), "conn send %u", i);
+    }
+
+    CHECK(st->samples >= 20, "%u RTT samples", st->samples);
+    CHECK(st->rtoUs == cfg.rtoMinUs, "RTO %u us", st->rtoUs);
+    CHECK(w5500_retry_window_ms(st->rtoUs, st->rcr) <= cfg.failWindowMs &&
+          w5500_retry_window_ms(st->rtoUs, st->rcr + 1) > cfg.failWindowMs,
+          "RCR %u for the window", st->rcr);
+    CHECK(w5500_read_reg(spi, W5500_RTR, buf, 2) && ((buf[0] << 8) | buf[1]) == 100 &&
+          w5500_read_reg(spi, W5500_RCR, buf, 1) && buf[0] == st->rcr, "RTR/RCR not written");
+
+    printf("ok   retry/keepalive registers, adaptive RTO over %u round trips\n", st->samples);
+}
+
+static int run_checks(void)
+{
+    W5500Sim_Stats st;
+
+    if (!setup()) {
+        printf("FAIL driver init: %s\n", w5500_sim_last_error());
+        return 1;
+    }
+
+    check_common();
+    check_udp_send();
+    check_tcp_recv();
+    check_udp_recv();
+    check_macraw();
+    check_retry();
+
+    w5500_sim_stats(&st);
+    if (st.errors != 0) {
+        printf("FAIL %u protocol error(s), last: %s\n", st.errors, w5500_sim_last_error());
+        failures++;
+    }
+
+    printf("%s\n", failures ? "FAILED" : "all checks passed");
+    return failures ? 1 : 0;
+}
+
+/*
+ *  ======== run_bench ========
+ *  Time the UDP send path: put + commit + SEND_OK per datagram.
+ */
+static int run_bench(uint32_t count)
+{
+    static uint8_t data[BENCH_DATAGRAM_LEN];
+    W5500Sim_Stats st;
+    W5500Sim_Stats end;
+    uint64_t busNs;
+    double t0;
+    double hostUs;
+    double busUs;
+    double spiBytes;
+    uint32_t i;
+
+    if (count == 0 || !setup() || !w5500_sock_udp_open(spi, SOCK_UDP, UDP_PORT, NULL)) {
+        printf("driver init failed: %s\n", w5500_sim_last_error());
+        return 1;
+    }
+    fill(data, sizeof(data), 1);
+
+    w5500_sim_stats(&st);
+    busNs = w5500_sim_shim_bus_ns();
+    t0 = now_us();
+
+    for (i = 0; i < count; i++) {
+        if (!w5500_sock_sendto(spi, SOCK_UDP, data, sizeof(data), dstIP, UDP_DST_PORT) ||
+            w5500_sock_settle(spi, SOCK_UDP, SETTLE_MS) != W5500_SOCK_READY) {
+            printf("send %u failed: %s\n", i, w5500_sim_last_error());
+            return 1;
+        }
+    }
+    w5500_spi_flush();
+
+    hostUs = now_us() - t0;
+    busUs  = (w5500_sim_shim_bus_ns() - busNs) / 1e3;
+    w5500_sim_stats(&end);
+    spiBytes = (double)(end.spiBytes - st.spiBytes) / count;
+
+    printf("%u datagrams of %u bytes at %u Hz SCLK\n", count, BENCH_DATAGRAM_LEN,
+           (unsigned)W5500_SPI_BITRATE);
+    printf("  SPI per datagram: %.1f frames, %.1f bytes (%.1f%% overhead)\n",
+           (double)(end.frames - st.frames) / count, spiBytes,
+           100.0 * (spiBytes - BENCH_DATAGRAM_LEN) / spiBytes);
+    printf("  bus time:  %.1f us per datagram, payload ceiling %.2f Mbit/s\n",
+           busUs / count, BENCH_DATAGRAM_LEN * 8.0 * count / busUs);
+    printf("  host time: %.1f us per datagram (driver + model)\n", hostUs / count);
+    printf("  interrupts %u, protocol errors %u\n", end.interrupts - st.interrupts, end.errors);
+
+    return end.errors ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "--check") == 0) {
+        return run_checks();
+    }
+    return run_bench((argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 2000);
+}
@@ -0,0 +1,752 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "w5500_sim.h"
+
+#define COMMON_LEN (0x40)
+#define SREG_LEN   (0x30)
+
+/* Common register offsets */
+#define C_MR       (0x00)
+#define C_IR       (0x15)
+#define C_IMR      (0x16)
+#define C_SIR      (0x17)
+#define C_SIMR     (0x18)
+#define C_RTR      (0x19)
+#define C_RCR      (0x1B)
+#define C_PHYCFGR  (0x2E)
+#define C_VERSIONR (0x39)
+
+/* Socket register offsets */
+#define S_MR         (0x00)
+#define S_CR         (0x01)
+#define S_IR         (0x02)
+#define S_SR         (0x03)
+#define S_DHAR       (0x06)
+#define S_DIPR       (0x0C)
+#define S_DPORT      (0x10)
+#define S_TTL        (0x16)
+#define S_RXBUF_SIZE (0x1E)
+#define S_TXBUF_SIZE (0x1F)
+#define S_TX_FSR     (0x20)
+#define S_TX_RD      (0x22)
+#define S_TX_WR      (0x24)
+#define S_RX_RSR     (0x26)
+#define S_RX_RD      (0x28)
+#define S_RX_WR      (0x2A)
+#define S_IMR        (0x2C)
+#define S_FRAG       (0x2D)
+
+/* Sn_MR protocol */
+#define MR_TCP    (0x01)
+#define MR_UDP    (0x02)
+#define MR_MACRAW (0x04)
+
+/* Sn_CR commands */
+#define CR_OPEN      (0x01)
+#define CR_LISTEN    (0x02)
+#define CR_CONNECT   (0x04)
+#define CR_DISCON    (0x08)
+#define CR_CLOSE     (0x10)
+#define CR_SEND      (0x20)
+#define CR_SEND_MAC  (0x21)
+#define CR_SEND_KEEP (0x22)
+#define CR_RECV      (0x40)
+
+/* Sn_IR bits */
+#define IR_CON     (0x01)
+#define IR_DISCON  (0x02)
+#define IR_RECV    (0x04)
+#define IR_TIMEOUT (0x08)
+#define IR_SEND_OK (0x10)
+
+/* Sn_SR values */
+#define SR_CLOSED      (0x00)
+#define SR_INIT        (0x13)
+#define SR_LISTEN      (0x14)
+#define SR_ESTABLISHED (0x17)
+#define SR_CLOSE_WAIT  (0x1C)
+#define SR_UDP         (0x22)
+#define SR_MACRAW      (0x42)
+
+/* Link up, 100 Mbps, full duplex, all capable auto-negotiation */
+#define PHYCFGR_LINK_UP (0xBF)
+
+#define UDP_HDR_LEN    (8)
+#define MACRAW_HDR_LEN (2)
+
+typedef enum
+{
+    PHASE_ADDR_H,
+    PHASE_ADDR_L,
+    PHASE_CTRL,
+    PHASE_DATA
+} FramePhase;
+
+typedef struct
+{
+    uint8_t  regs[SREG_LEN];
+    uint16_t rxAcked;  /* Sn_RX_RD at the last RECV, what the chip may reuse */
+} SimSocket;
+
+static pthread_mutex_t simLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+static uint8_t   common[COMMON_LEN];
+static SimSocket sock[W5500_SIM_NUM_SOCK];
+static uint8_t   txMem[W5500_SIM_MEM_SIZE];
+static uint8_t   rxMem[W5500_SIM_MEM_SIZE];
+static uint8_t   scratch[W5500_SIM_MEM_SIZE];
+
+/* Frame being clocked in */
+static bool       csLow = false;
+static FramePhase phase;
+static uint16_t   addr;
+static uint8_t    ctrl;
+static uint8_t    fixedLeft;  /* bytes left of a fixed-length frame, 0 in VDM */
+
+static bool intLevel = true;
+static bool intEdge = false;  /* raised under simLock, reported after it */
+
+static bool acceptConnect = true;
+static bool arpFailOnZeroIP = true;
+
+static W5500Sim_TxFxn  txFxn = NULL;
+static W5500Sim_IntFxn intFxn = NULL;
+
+static W5500Sim_Stats stats;
+static char lastError[128];
+
+static void sim_error(const char *fmt, unsigned a, unsigned b)
+{
+    stats.errors++;
+    snprintf(lastError, sizeof(lastError), fmt, a, b);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (v >> 8) & 0xFF;
+    p[1] = v & 0xFF;
+}
+
+/*
+ *  ======== buf_base ========
+ *  Socket buffers are carved from the 16 KB memories in socket order, so a
+ *  size table that oversubscribes the memory makes sockets overlap here
+ *  just as on the chip.
+ */
+static uint16_t buf_base(uint8_t sn, uint8_t sizeReg)
+{
+    uint16_t base = 0;
+    uint8_t i;
+
+    for (i = 0; i < sn; i++) {
+        base += sock[i].regs[sizeReg] * 1024;
+    }
+    return base;
+}
+
+static uint16_t buf_size(uint8_t sn, uint8_t sizeReg)
+{
+    return sock[sn].regs[sizeReg] * 1024;
+}
+
+static uint8_t *buf_byte(uint8_t *mem, uint8_t sn, uint8_t sizeReg, uint16_t ptr)
+{
+    uint16_t size = buf_size(sn, sizeReg);
+
+    if (size == 0) {
+        return NULL;
+    }
+    return &mem[(buf_base(sn, sizeReg) + (ptr & (size - 1))) % W5500_SIM_MEM_SIZE];
+}
+
+static uint16_t tx_free(uint8_t sn)
+{
+    return buf_size(sn, S_TXBUF_SIZE) -
+           (uint16_t)(get16(&sock[sn].regs[S_TX_WR]) - get16(&sock[sn].regs[S_TX_RD]));
+}
+
+static uint16_t rx_used(uint8_t sn)
+{
+    return (uint16_t)(get16(&sock[sn].regs[S_RX_WR]) - sock[sn].rxAcked);
+}
+
+/*
+ *  ======== update_int ========
+ *  Recompute SIR and INTn; a high-to-low transition is an interrupt.
+ */
+static void update_int(void)
+{
+    uint8_t sir = 0;
+    bool level;
+    uint8_t sn;
+
+    for (sn = 0; sn < W5500_SIM_NUM_SOCK; sn++) {
+        if (sock[sn].regs[S_IR] & sock[sn].regs[S_IMR]) {
+            sir |= 1 << sn;
+        }
+    }
+    common[C_SIR] = sir;
+
+    level = !((sir & common[C_SIMR]) || (common[C_IR] & common[C_IMR]));
+    if (intLevel && !level) {
+        stats.interrupts++;
+        intEdge = true;
+    }
+    intLevel = level;
+}
+
+/*
+ *  ======== sim_unlock ========
+ *  Release the model, then report an INTn edge. The callback takes the
+ *  shim's interrupt lock, which SPI completions hold while clocking the
+ *  model, so it must not run under simLock.
+ */
+static void sim_unlock(void)
+{
+    W5500Sim_IntFxn fxn = intEdge ? intFxn : NULL;
+
+    intEdge = false;
+    pthread_mutex_unlock(&simLock);
+
+    if (fxn != NULL) {
+        fxn();
+    }
+}
+
+static void sock_reset(uint8_t sn)
+{
+    uint8_t *r = sock[sn].regs;
+
+    memset(r, 0, SREG_LEN);
+    memset(&r[S_DHAR], 0xFF, 6);
+    r[S_TTL]        = 0x80;
+    r[S_RXBUF_SIZE] = 2;
+    r[S_TXBUF_SIZE] = 2;
+    r[S_IMR]        = 0xFF;
+    put16(&r[S_FRAG], 0x4000);
+    sock[sn].rxAcked = 0;
+}
+
+static void chip_reset(void)
+{
+    uint8_t sn;
+
+    memset(common, 0, sizeof(common));
+    put16(&common[C_RTR], 2000);
+    common[C_RCR]      = 8;
+    common[C_PHYCFGR]  = PHYCFGR_LINK_UP;
+    common[C_VERSIONR] = W5500_SIM_VERSION;
+
+    for (sn = 0; sn < W5500_SIM_NUM_SOCK; sn++) {
+        sock_reset(sn);
+    }
+    memset(txMem, 0, sizeof(txMem));
+    memset(rxMem, 0, sizeof(rxMem));
+    intLevel = true;
+    intEdge  = false;
+}
+
+static void sock_open(uint8_t sn)
+{
+    uint8_t *r = sock[sn].regs;
+    uint16_t txTotal = 0;
+    uint16_t rxTotal = 0;
+    uint8_t i;
+
+    if (r[S_SR] != SR_CLOSED) {
+        sim_error("socket %u: OPEN in Sn_SR 0x%02x", sn, r[S_SR]);
+        return;
+    }
+
+    for (i = 0; i < W5500_SIM_NUM_SOCK; i++) {
+        txTotal += sock[i].regs[S_TXBUF_SIZE];
+        rxTotal += sock[i].regs[S_RXBUF_SIZE];
+    }
+    if (txTotal > 16 || rxTotal > 16) {
+        sim_error("buffer sizes total TX %u KB, RX %u KB", txTotal, rxTotal);
+    }
+
+    switch (r[S_MR] & 0x0F) {
+    case MR_TCP:
+        r[S_SR] = SR_INIT;
+        break;
+    case MR_UDP:
+        r[S_SR] = SR_UDP;
+        break;
+    case MR_MACRAW:
+        if (sn == 0) {
+            r[S_SR] = SR_MACRAW;
+            break;
+        }
+        // fall through
+    default:
+        sim_error("socket %u: OPEN with Sn_MR 0x%02x", sn, r[S_MR]);
+        return;
+    }
+
+    put16(&r[S_TX_RD], 0);
+    put16(&r[S_TX_WR], 0);
+    put16(&r[S_RX_RD], 0);
+    put16(&r[S_RX_WR], 0);
+    sock[sn].rxAcked = 0;
+}
+
+static void sock_send(uint8_t sn)
+{
+    uint8_t *r = sock[sn].regs;
+    W5500Sim_Packet pkt;
+    uint16_t rd = get16(&r[S_TX_RD]);
+    uint16_t wr = get16(&r[S_TX_WR]);
+    uint16_t len = wr - rd;
+    uint16_t i;
+
+    if (r[S_SR] != SR_ESTABLISHED && r[S_SR] != SR_CLOSE_WAIT &&
+        r[S_SR] != SR_UDP && r[S_SR] != SR_MACRAW) {
+        sim_error("socket %u: SEND in Sn_SR 0x%02x", sn, r[S_SR]);
+        return;
+    }
+    if (len > buf_size(sn, S_TXBUF_SIZE)) {
+        sim_error("socket %u: SEND of %u bytes overruns the TX buffer", sn, len);
+        return;
+    }
+
+    put16(&r[S_TX_RD], wr);
+
+    if (r[S_SR] == SR_UDP && arpFailOnZeroIP &&
+        (r[S_DIPR] | r[S_DIPR + 1] | r[S_DIPR + 2] | r[S_DIPR + 3]) == 0) {
+        r[S_IR] |= IR_TIMEOUT;
+        return;
+    }
+
+    for (i = 0; i < len; i++) {
+        scratch[i] = *buf_byte(txMem, sn, S_TXBUF_SIZE, rd + i);
+    }
+
+    if (len > 0) {
+        stats.sends++;
+        stats.sentBytes += len;
+        if (txFxn != NULL) {
+            pkt.sn      = sn;
+            pkt.mode    = r[S_MR] & 0x0F;
+            memcpy(pkt.dstIP, &r[S_DIPR], 4);
+            pkt.dstPort = get16(&r[S_DPORT]);
+            pkt.data    = scratch;
+            pkt.len     = len;
+            txFxn(&pkt);
+        }
+    }
+    r[S_IR] |= IR_SEND_OK;
+}
+
+static void sock_command(uint8_t sn, uint8_t cmd)
+{
+    uint8_t *r = sock[sn].regs;
+    uint16_t rd;
+
+    switch (cmd) {
+    case CR_OPEN:
+        sock_open(sn);
+        break;
+
+    case CR_LISTEN:
+        if (r[S_SR] != SR_INIT) {
+            sim_error("socket %u: LISTEN in Sn_SR 0x%02x", sn, r[S_SR]);
+            break;
+        }
+        r[S_SR] = SR_LISTEN;
+        break;
+
+    case CR_CONNECT:
+        if (r[S_SR] != SR_INIT) {
+            sim_error("socket %u: CONNECT in Sn_SR 0x%02x", sn, r[S_SR]);
+            break;
+        }
+        if (acceptConnect) {
+            r[S_SR] = SR_ESTABLISHED;
+            r[S_IR] |= IR_CON;
+        } else {
+            // Retransmissions exhausted
+            r[S_SR] = SR_CLOSED;
+            r[S_IR] |= IR_TIMEOUT;
+        }
+        break;
+
+    case CR_DISCON:
+        if (r[S_SR] != SR_ESTABLISHED && r[S_SR] != SR_CLOSE_WAIT) {
+            sim_error("socket %u: DISCON in Sn_SR 0x%02x", sn, r[S_SR]);
+            break;
+        }
+        r[S_SR] = SR_CLOSED;
+        r[S_IR] |= IR_DISCON;
+        break;
+
+    case CR_CLOSE:
+        r[S_SR] = SR_CLOSED;
+        break;
+
+    case CR_SEND:
+    case CR_SEND_MAC:
+        sock_send(sn);
+        break;
+
+    case CR_SEND_KEEP:
+        if (r[S_SR] != SR_ESTABLISHED) {
+            sim_error("socket %u: SEND_KEEP in Sn_SR 0x%02x", sn, r[S_SR]);
+        }
+        break;
+
+    case CR_RECV:
+        rd = get16(&r[S_RX_RD]);
+        if ((uint16_t)(rd - sock[sn].rxAcked) > rx_used(sn)) {
+            sim_error("socket %u: Sn_RX_RD moved %u bytes past Sn_RX_WR",
+                      sn, (uint16_t)(rd - get16(&r[S_RX_WR])));
+            break;
+        }
+        stats.recvBytes += (uint16_t)(rd - sock[sn].rxAcked);
+        sock[sn].rxAcked = rd;
+        if (rx_used(sn) > 0) {
+            r[S_IR] |= IR_RECV;
+        }
+        break;
+
+    default:
+        sim_error("socket %u: unknown command 0x%02x", sn, cmd);
+        break;
+    }
+}
+
+static uint8_t read_byte(uint8_t bsb, uint16_t a)
+{
+    uint8_t sn = (bsb - 1) / 4;
+    uint8_t *p;
+
+    if (bsb == 0) {
+        return (a < COMMON_LEN) ? common[a] : 0;
+    }
+
+    switch (bsb % 4) {
+    case 1:
+        if (a >= SREG_LEN) {
+            return 0;
+        }
+        // The free/received counts are live, not latched
+        if (a == S_TX_FSR || a == S_TX_FSR + 1) {
+            return (tx_free(sn) >> ((a == S_TX_FSR) ? 8 : 0)) & 0xFF;
+        }
+        if (a == S_RX_RSR || a == S_RX_RSR + 1) {
+            return (rx_used(sn) >> ((a == S_RX_RSR) ? 8 : 0)) & 0xFF;
+        }
+        return sock[sn].regs[a];
+    case 2:
+        p = buf_byte(txMem, sn, S_TXBUF_SIZE, a);
+        return (p != NULL) ? *p : 0;
+    case 3:
+        p = buf_byte(rxMem, sn, S_RXBUF_SIZE, a);
+        return (p != NULL) ? *p : 0;
+    default:
+        sim_error("read of reserved block %u", bsb, 0);
+        return 0;
+    }
+}
+
+static void write_byte(uint8_t bsb, uint16_t a, uint8_t v)
+{
+    uint8_t sn = (bsb - 1) / 4;
+    uint8_t *p;
+
+    if (bsb == 0) {
+        if (a >= COMMON_LEN) {
+            return;
+        }
+        switch (a) {
+        case C_MR:
+            if (v & 0x80) {
+                chip_reset();
+                return;
+            }
+            common[a] = v;
+            break;
+        case C_IR:
+            common[a] &= ~v;
+            break;
+        case C_SIR:
+        case C_PHYCFGR:
+        case C_VERSIONR:
+            sim_error("write to read-only common register 0x%04x", a, 0);
+            break;
+        default:
+            common[a] = v;
+            break;
+        }
+        return;
+    }
+
+    switch (bsb % 4) {
+    case 1:
+        if (a >= SREG_LEN) {
+            return;
+        }
+        switch (a) {
+        case S_CR:
+            sock_command(sn, v);
+            break;
+        case S_IR:
+            sock[sn].regs[a] &= ~v;
+            break;
+        case S_SR:
+        case S_TX_FSR: case S_TX_FSR + 1:
+        case S_TX_RD:  case S_TX_RD + 1:
+        case S_RX_RSR: case S_RX_RSR + 1:
+        case S_RX_WR:  case S_RX_WR + 1:
+            sim_error("socket %u: write to read-only register 0x%02x", sn, a);
+            break;
+        default:
+            sock[sn].regs[a] = v;
+            break;
+        }
+        break;
+    case 2:
+        p = buf_byte(txMem, sn, S_TXBUF_SIZE, a);
+        if (p == NULL) {
+            sim_error("socket %u: TX write with no TX buffer", sn, 0);
+            break;
+        }
+        *p = v;
+        break;
+    case 3:
+        sim_error("socket %u: write into the RX buffer at 0x%04x", sn, a);
+        break;
+    default:
+        sim_error("write to reserved block %u", bsb, 0);
+        break;
+    }
+}
+
+void w5500_sim_reset(void)
+{
+    pthread_mutex_lock(&simLock);
+    chip_reset();
+    csLow = false;
+    memset(&stats, 0, sizeof(stats));
+    lastError[0] = '\0';
+    sim_unlock();
+}
+
+void w5500_sim_set_tx_fxn(W5500Sim_TxFxn fxn)
+{
+    pthread_mutex_lock(&simLock);
+    txFxn = fxn;
+    sim_unlock();
+}
+
+void w5500_sim_set_int_fxn(W5500Sim_IntFxn fxn)
+{
+    pthread_mutex_lock(&simLock);
+    intFxn = fxn;
+    sim_unlock();
+}
+
+void w5500_sim_set_peer(bool accept, bool arpFail)
+{
+    pthread_mutex_lock(&simLock);
+    acceptConnect   = accept;
+    arpFailOnZeroIP = arpFail;
+    sim_unlock();
+}
+
+void w5500_sim_cs(bool low)
+{
+    pthread_mutex_lock(&simLock);
+    if (low && !csLow) {
+        phase = PHASE_ADDR_H;
+    } else if (!low && csLow) {
+        stats.frames++;
+        if (phase != PHASE_DATA) {
+            sim_error("frame ended after %u header bytes", phase, 0);
+        }
+        // Commands and clears take effect at the end of the frame
+        update_int();
+    }
+    csLow = low;
+    sim_unlock();
+}
+
+void w5500_sim_clock(const uint8_t *mosi, uint8_t *miso, size_t len)
+{
+    static const uint8_t fixedLen[4] = {0, 1, 2, 4};
+    uint8_t in;
+    uint8_t out;
+    size_t i;
+
+    pthread_mutex_lock(&simLock);
+    if (!csLow) {
+        // Another device's transfer; MISO is high-Z, reads as pulled up
+        if (miso != NULL) {
+            memset(miso, 0xFF, len);
+        }
+        sim_unlock();
+        return;
+    }
+
+    stats.spiBytes += len;
+    for (i = 0; i < len; i++) {
+        in  = (mosi != NULL) ? mosi[i] : 0;
+        out = 0;
+
+        switch (phase) {
+        case PHASE_ADDR_H:
+            addr  = (uint16_t)in << 8;
+            phase = PHASE_ADDR_L;
+            break;
+        case PHASE_ADDR_L:
+            addr |= in;
+            phase = PHASE_CTRL;
+            break;
+        case PHASE_CTRL:
+            ctrl      = in;
+            fixedLeft = fixedLen[ctrl & 0x03];
+            phase     = PHASE_DATA;
+            break;
+        case PHASE_DATA:
+            stats.dataBytes++;
+            if (ctrl & 0x04) {
+                write_byte(ctrl >> 3, addr, in);
+            } else {
+                out = read_byte(ctrl >> 3, addr);
+            }
+            addr++;
+            // Fixed-length mode: the next byte starts a new header
+            if (fixedLeft > 0 && --fixedLeft == 0) {
+                phase = PHASE_ADDR_H;
+            }
+            break;
+        }
+
+        if (miso != NULL) {
+            miso[i] = out;
+        }
+    }
+    sim_unlock();
+}
+
+bool w5500_sim_int_level(void)
+{
+    bool level;
+
+    pthread_mutex_lock(&simLock);
+    level = intLevel;
+    sim_unlock();
+    return level;
+}
+
+bool w5500_sim_peer_connect(uint8_t sn)
+{
+    bool ok = false;
+
+    pthread_mutex_lock(&simLock);
+    if (sn < W5500_SIM_NUM_SOCK && sock[sn].regs[S_SR] == SR_LISTEN) {
+        sock[sn].regs[S_SR] = SR_ESTABLISHED;
+        sock[sn].regs[S_IR] |= IR_CON;
+        update_int();
+        ok = true;
+    }
+    sim_unlock();
+    return ok;
+}
+
+bool w5500_sim_peer_send(uint8_t sn, const uint8_t srcIP[4], uint16_t srcPort,
+                         const uint8_t *data, uint16_t len)
+{
+    uint8_t hdr[UDP_HDR_LEN];
+    uint8_t *r;
+    uint16_t hdrLen = 0;
+    uint16_t wr;
+    uint16_t i;
+    bool ok = false;
+
+    pthread_mutex_lock(&simLock);
+    if (sn >= W5500_SIM_NUM_SOCK) {
+        goto out;
+    }
+    r = sock[sn].regs;
+
+    if (r[S_SR] == SR_UDP) {
+        memcpy(hdr, srcIP, 4);
+        put16(&hdr[4], srcPort);
+        put16(&hdr[6], len);
+        hdrLen = UDP_HDR_LEN;
+    } else if (r[S_SR] == SR_MACRAW) {
+        // Frame length word, counting itself
+        put16(hdr, len + MACRAW_HDR_LEN);
+        hdrLen = MACRAW_HDR_LEN;
+    } else if (r[S_SR] != SR_ESTABLISHED) {
+        goto out;
+    }
+
+    if (hdrLen + len > buf_size(sn, S_RXBUF_SIZE) - rx_used(sn)) {
+        goto out;
+    }
+
+    wr = get16(&r[S_RX_WR]);
+    for (i = 0; i < hdrLen; i++) {
+        *buf_byte(rxMem, sn, S_RXBUF_SIZE, wr++) = hdr[i];
+    }
+    for (i = 0; i < len; i++) {
+        *buf_byte(rxMem, sn, S_RXBUF_SIZE, wr++) = data[i];
+    }
+    put16(&r[S_RX_WR], wr);
+
+    r[S_IR] |= IR_RECV;
+    update_int();
+    ok = true;
+
+out:
+    sim_unlock();
+    return ok;
+}
+
+bool w5500_sim_peer_close(uint8_t sn)
+{
+    bool ok = false;
+
+    pthread_mutex_lock(&simLock);
+    if (sn < W5500_SIM_NUM_SOCK && sock[sn].regs[S_SR] == SR_ESTABLISHED) {
+        sock[sn].regs[S_SR] = SR_CLOSE_WAIT;
+        sock[sn].regs[S_IR] |= IR_DISCON;
+        update_int();
+        ok = true;
+    }
+    sim_unlock();
+    return ok;
+}
+
+uint8_t w5500_sim_status(uint8_t sn)
+{
+    uint8_t sr;
+
+    pthread_mutex_lock(&simLock);
+    sr = (sn < W5500_SIM_NUM_SOCK) ? sock[sn].regs[S_SR] : SR_CLOSED;
+    sim_unlock();
+    return sr;
+}
+
+void w5500_sim_stats(W5500Sim_Stats *out)
+{
+    pthread_mutex_lock(&simLock);
+    *out = stats;
+    sim_unlock();
+}
+
+const char *w5500_sim_last_error(void)
+{
+    return lastError;
+}
@@ -0,0 +1,117 @@
+/*
+ *  ======== w5500_sim.h ========
+ *  Register-level software model of the WIZnet W5500 for host builds.
+ *
+ *  The model decodes SPI frames exactly as the chip does: [addr H][addr L]
+ *  [BSB<<3 | RWB<<2 | OM] followed by data, auto-incrementing the address
+ *  for as long as CS stays low. It keeps the common and socket register
+ *  blocks, the 16 KB TX and RX buffer memories with their Sn_TX_RD/WR and
+ *  Sn_RX_RD/WR ring pointers, runs Sn_CR commands through the Sn_SR state
+ *  machine, and drives INTn from Sn_IR/Sn_IMR/SIMR.
+ *
+ *  There is no network: SEND hands the payload to a W5500Sim_TxFxn, and
+ *  the peer side (accepting a connection, data arriving, closing) is played
+ *  by w5500_sim_peer_xxx() calls. Everything completes instantly, so the
+ *  model measures SPI traffic, not wire time.
+ *
+ *  w5500_sim_shim.c connects the model to the TI SPI/GPIO driver API, so
+ *  the firmware's W5500 driver sources build and run on Linux unchanged.
+ */
+#ifndef W5500_SIM_H_
+#define W5500_SIM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define W5500_SIM_NUM_SOCK (8)
+#define W5500_SIM_MEM_SIZE (16 * 1024)  /* each of TX and RX */
+
+/* VERSIONR of real silicon */
+#define W5500_SIM_VERSION (0x04)
+
+typedef struct
+{
+    uint8_t        sn;
+    uint8_t        mode;       /* Sn_MR protocol bits at SEND */
+    uint8_t        dstIP[4];   /* Sn_DIPR, UDP only */
+    uint16_t       dstPort;    /* Sn_DPORT, UDP only */
+    const uint8_t *data;       /* valid during the callback only */
+    uint16_t       len;
+} W5500Sim_Packet;
+
+/* Called with the payload of every SEND, under the model's lock */
+typedef void (*W5500Sim_TxFxn)(const W5500Sim_Packet *pkt);
+
+/* Called on every falling edge of INTn */
+typedef void (*W5500Sim_IntFxn)(void);
+
+typedef struct
+{
+    uint32_t frames;      /* CS low-to-high periods */
+    uint32_t spiBytes;    /* all bytes clocked, headers included */
+    uint32_t dataBytes;   /* bytes after the 3-byte headers */
+    uint32_t sends;       /* SEND commands that moved data */
+    uint32_t sentBytes;
+    uint32_t recvBytes;   /* bytes the host freed with RECV */
+    uint32_t interrupts;  /* INTn falling edges */
+    uint32_t errors;      /* protocol violations, see w5500_sim_last_error() */
+} W5500Sim_Stats;
+
+/*
+ *  ======== w5500_sim_reset ========
+ *  Power-on reset: registers to their datasheet defaults, buffers 2 KB per
+ *  socket, all sockets closed, statistics cleared.
+ */
+void w5500_sim_reset(void);
+
+void w5500_sim_set_tx_fxn(W5500Sim_TxFxn fxn);
+void w5500_sim_set_int_fxn(W5500Sim_IntFxn fxn);
+
+/*
+ *  ======== w5500_sim_set_peer ========
+ *  Behaviour of the remote end: whether CONNECT is answered (else the
+ *  socket times out), and whether sending UDP to an unresolvable address
+ *  (0.0.0.0) times out like a failed ARP.
+ */
+void w5500_sim_set_peer(bool acceptConnect, bool arpFailOnZeroIP);
+
+/* SPI interface: CS level and bytes clocked while it is low */
+void w5500_sim_cs(bool low);
+void w5500_sim_clock(const uint8_t *mosi, uint8_t *miso, size_t len);
+
+/* Level of INTn, false while an interrupt is pending */
+bool w5500_sim_int_level(void);
+
+/*
+ *  ======== w5500_sim_peer_connect ========
+ *  A peer connects to LISTENing socket sn: ESTABLISHED and CON.
+ */
+bool w5500_sim_peer_connect(uint8_t sn);
+
+/*
+ *  ======== w5500_sim_peer_send ========
+ *  Data arrives for socket sn. On a UDP socket it is one datagram from
+ *  srcIP:srcPort and gets the chip's 8-byte header; on a MACRAW socket it
+ *  is one Ethernet frame and gets the 2-byte length word; on TCP it is
+ *  stream data. srcIP/srcPort only matter for UDP. Fails if the RX buffer
+ *  lacks the room.
+ */
+bool w5500_sim_peer_send(uint8_t sn, const uint8_t srcIP[4], uint16_t srcPort,
+                         const uint8_t *data, uint16_t len);
+
+/*
+ *  ======== w5500_sim_peer_close ========
+ *  The peer sends FIN on ESTABLISHED socket sn: CLOSE_WAIT and DISCON.
+ */
+bool w5500_sim_peer_close(uint8_t sn);
+
+/* Sn_SR of socket sn */
+uint8_t w5500_sim_status(uint8_t sn);
+
+void w5500_sim_stats(W5500Sim_Stats *stats);
+
+/* Description of the most recent protocol violation, "" if none */
+const char *w5500_sim_last_error(void);
+
+#endif /* W5500_SIM_H_ */
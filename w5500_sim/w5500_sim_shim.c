@@ -0,0 +1,444 @@
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <FreeRTOS.h>
+#include <queue.h>
+
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/SPI.h>
+#include <ti/drivers/dpl/HwiP.h>
+#include <ti/display/Display.h>
+
+#include "ti_drivers_config.h"
+
+#include "w5500_sim.h"
+#include "w5500_sim_shim.h"
+
+#define GPIO_NUM_PINS (32)
+
+struct SPI_Config_
+{
+    bool            isOpen;
+    SPI_Params      params;
+    SPI_Transaction *pending;  /* callback mode: waiting for the worker */
+};
+
+struct QueueDefinition
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+    UBaseType_t     length;
+    UBaseType_t     itemSize;
+    UBaseType_t     count;
+    UBaseType_t     head;
+    uint8_t         items[];
+};
+
+struct Display_Config
+{
+    int unused;
+};
+
+/* "Interrupts disabled": held by HwiP_disable() and around every callback */
+static pthread_mutex_t hwiLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static pthread_cond_t  xferCond = PTHREAD_COND_INITIALIZER;
+
+static struct SPI_Config_ spiConfig;
+static bool workerStarted = false;
+static uint64_t busNs = 0;
+static uint32_t opens = 0;
+
+static GPIO_PinConfig   gpioConfig[GPIO_NUM_PINS];
+static GPIO_CallbackFxn gpioCallback[GPIO_NUM_PINS];
+static bool             gpioIntEnabled[GPIO_NUM_PINS];
+static bool             gpioIntLatched[GPIO_NUM_PINS];
+static uint8_t          gpioLevel[GPIO_NUM_PINS];
+
+static struct Display_Config displayConfig;
+
+uintptr_t HwiP_disable(void)
+{
+    pthread_mutex_lock(&hwiLock);
+    return 0;
+}
+
+void HwiP_restore(uintptr_t key)
+{
+    (void)key;
+    pthread_mutex_unlock(&hwiLock);
+}
+
+/*
+ *  ======== spi_clock ========
+ *  Clock one transaction through the model and account its bus time.
+ */
+static void spi_clock(SPI_Transaction *trans)
+{
+    w5500_sim_clock(trans->txBuf, trans->rxBuf, trans->count);
+    busNs += (uint64_t)trans->count * 8 * 1000000000ULL / spiConfig.params.bitRate;
+    trans->status = SPI_TRANSFER_COMPLETED;
+}
+
+/*
+ *  ======== spiWorker ========
+ *  Stands in for the SPI DMA interrupt of callback mode.
+ */
+static void *spiWorker(void *arg)
+{
+    SPI_Transaction *trans;
+
+    (void)arg;
+
+    pthread_mutex_lock(&hwiLock);
+    while (1) {
+        while (spiConfig.pending == NULL) {
+            pthread_cond_wait(&xferCond, &hwiLock);
+        }
+        trans = spiConfig.pending;
+        spiConfig.pending = NULL;
+
+        spi_clock(trans);
+        spiConfig.params.transferCallbackFxn(&spiConfig, trans);
+    }
+    return NULL;
+}
+
+void SPI_init(void)
+{
+}
+
+void SPI_Params_init(SPI_Params *params)
+{
+    memset(params, 0, sizeof(*params));
+    params->transferMode    = SPI_MODE_BLOCKING;
+    params->transferTimeout = SPI_WAIT_FOREVER;
+    params->mode            = SPI_CONTROLLER;
+    params->bitRate         = 1000000;
+    params->dataSize        = 8;
+    params->frameFormat     = SPI_POL0_PHA0;
+}
+
+SPI_Handle SPI_open(uint_least8_t index, SPI_Params *params)
+{
+    pthread_t thread;
+    SPI_Handle handle = NULL;
+
+    pthread_mutex_lock(&hwiLock);
+    if (index == CONFIG_SPI_CONTROLLER && !spiConfig.isOpen && params->bitRate > 0 &&
+        (params->transferMode == SPI_MODE_BLOCKING || params->transferCallbackFxn != NULL)) {
+        // The W5500 samples on the rising edge: SPI mode 0 or 3 only
+        if (params->frameFormat != SPI_POL0_PHA0 && params->frameFormat != SPI_POL1_PHA1) {
+            fprintf(stderr, "w5500_sim: SPI frame format %d is not mode 0 or 3\n",
+                    params->frameFormat);
+        }
+        spiConfig.isOpen  = true;
+        spiConfig.params  = *params;
+        spiConfig.pending = NULL;
+        opens++;
+        handle = &spiConfig;
+
+        if (!workerStarted) {
+            if (pthread_create(&thread, NULL, spiWorker, NULL) != 0) {
+                abort();
+            }
+            pthread_detach(thread);
+            workerStarted = true;
+        }
+    }
+    pthread_mutex_unlock(&hwiLock);
+    return handle;
+}
+
+void SPI_close(SPI_Handle handle)
+{
+    pthread_mutex_lock(&hwiLock);
+    if (handle->pending != NULL) {
+        fprintf(stderr, "w5500_sim: SPI_close with a transfer in flight\n");
+    }
+    handle->isOpen = false;
+    pthread_mutex_unlock(&hwiLock);
+}
+
+bool SPI_transfer(SPI_Handle handle, SPI_Transaction *trans)
+{
+    bool ok = true;
+
+    pthread_mutex_lock(&hwiLock);
+    if (!handle->isOpen || trans->count == 0) {
+        ok = false;
+    } else if (handle->params.transferMode == SPI_MODE_BLOCKING) {
+        spi_clock(trans);
+    } else if (handle->pending != NULL) {
+        // Callback mode takes one transaction at a time here
+        ok = false;
+    } else {
+        trans->status   = SPI_TRANSFER_STARTED;
+        handle->pending = trans;
+        pthread_cond_signal(&xferCond);
+    }
+    pthread_mutex_unlock(&hwiLock);
+    return ok;
+}
+
+void SPI_transferCancel(SPI_Handle handle)
+{
+    pthread_mutex_lock(&hwiLock);
+    if (handle->pending != NULL) {
+        handle->pending->status = SPI_TRANSFER_CANCELED;
+        handle->params.transferCallbackFxn(handle, handle->pending);
+        handle->pending = NULL;
+    }
+    pthread_mutex_unlock(&hwiLock);
+}
+
+/*
+ *  ======== simIntFxn ========
+ *  Falling edge on INTn from the model.
+ */
+static void simIntFxn(void)
+{
+    uint_least8_t pin = W5500_SIM_INT_GPIO;
+
+    pthread_mutex_lock(&hwiLock);
+    if ((gpioConfig[pin] & GPIO_CFG_IN_INT_FALLING) && gpioCallback[pin] != NULL) {
+        if (gpioIntEnabled[pin]) {
+            gpioCallback[pin](pin);
+        } else {
+            gpioIntLatched[pin] = true;
+        }
+    }
+    pthread_mutex_unlock(&hwiLock);
+}
+
+void GPIO_init(void)
+{
+    w5500_sim_set_int_fxn(simIntFxn);
+}
+
+int_fast16_t GPIO_setConfig(uint_least8_t index, GPIO_PinConfig pinConfig)
+{
+    if (index >= GPIO_NUM_PINS) {
+        return -1;
+    }
+    gpioConfig[index] = pinConfig;
+    if (pinConfig & GPIO_CFG_OUT_HIGH) {
+        gpioLevel[index] = 1;
+    }
+    return 0;
+}
+
+void GPIO_setCallback(uint_least8_t index, GPIO_CallbackFxn callback)
+{
+    if (index < GPIO_NUM_PINS) {
+        gpioCallback[index] = callback;
+    }
+}
+
+void GPIO_enableInt(uint_least8_t index)
+{
+    bool fire;
+
+    if (index >= GPIO_NUM_PINS) {
+        return;
+    }
+
+    pthread_mutex_lock(&hwiLock);
+    gpioIntEnabled[index] = true;
+    // An edge seen while disabled is still flagged, as on the target
+    fire = gpioIntLatched[index];
+    gpioIntLatched[index] = false;
+    if (fire && gpioCallback[index] != NULL) {
+        gpioCallback[index](index);
+    }
+    pthread_mutex_unlock(&hwiLock);
+}
+
+void GPIO_disableInt(uint_least8_t index)
+{
+    if (index < GPIO_NUM_PINS) {
+        gpioIntEnabled[index] = false;
+    }
+}
+
+void GPIO_clearInt(uint_least8_t index)
+{
+    if (index < GPIO_NUM_PINS) {
+        gpioIntLatched[index] = false;
+    }
+}
+
+void GPIO_write(uint_least8_t index, unsigned int value)
+{
+    if (index >= GPIO_NUM_PINS) {
+        return;
+    }
+    gpioLevel[index] = value ? 1 : 0;
+    if (index == CONFIG_GPIO_SPI_CONTROLLER_CSN) {
+        w5500_sim_cs(value == 0);
+    }
+}
+
+uint_fast8_t GPIO_read(uint_least8_t index)
+{
+    if (index == W5500_SIM_INT_GPIO) {
+        return w5500_sim_int_level() ? 1 : 0;
+    }
+    return (index < GPIO_NUM_PINS) ? gpioLevel[index] : 0;
+}
+
+void GPIO_toggle(uint_least8_t index)
+{
+    if (index < GPIO_NUM_PINS) {
+        GPIO_write(index, !gpioLevel[index]);
+    }
+}
+
+void Display_init(void)
+{
+}
+
+Display_Handle Display_open(uint32_t id, void *params)
+{
+    (void)id;
+    (void)params;
+    return &displayConfig;
+}
+
+void Display_printf(Display_Handle handle, uint8_t line, uint8_t column, const char *fmt, ...)
+{
+    va_list ap;
+
+    (void)handle;
+    (void)line;
+    (void)column;
+
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    putchar('\n');
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t uxQueueLength, UBaseType_t uxItemSize)
+{
+    QueueHandle_t q = calloc(1, sizeof(*q) + uxQueueLength * uxItemSize);
+
+    if (q == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->changed, NULL);
+    q->length   = uxQueueLength;
+    q->itemSize = uxItemSize;
+    return q;
+}
+
+/*
+ *  ======== queue_wait ========
+ *  Wait on q->changed until ready() or ticks (ms) pass. Called locked.
+ */
+static bool queue_wait(QueueHandle_t q, bool (*ready)(QueueHandle_t), TickType_t ticks)
+{
+    struct timespec ts;
+
+    if (ticks != portMAX_DELAY) {
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec  += ticks / 1000;
+        ts.tv_nsec += (long)(ticks % 1000) * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+    }
+
+    while (!ready(q)) {
+        if (ticks == 0) {
+            return false;
+        }
+        if (ticks == portMAX_DELAY) {
+            pthread_cond_wait(&q->changed, &q->lock);
+        } else if (pthread_cond_timedwait(&q->changed, &q->lock, &ts) != 0) {
+            return ready(q);
+        }
+    }
+    return true;
+}
+
+static bool queue_has_room(QueueHandle_t q)
+{
+    return q->count < q->length;
+}
+
+static bool queue_has_item(QueueHandle_t q)
+{
+    return q->count > 0;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    BaseType_t ret = pdFAIL;
+
+    pthread_mutex_lock(&q->lock);
+    if (queue_wait(q, queue_has_room, ticks)) {
+        memcpy(&q->items[((q->head + q->count) % q->length) * q->itemSize], item, q->itemSize);
+        q->count++;
+        pthread_cond_broadcast(&q->changed);
+        ret = pdPASS;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ret;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item, BaseType_t *woken)
+{
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    BaseType_t ret = pdFAIL;
+
+    pthread_mutex_lock(&q->lock);
+    if (queue_wait(q, queue_has_item, ticks)) {
+        memcpy(item, &q->items[q->head * q->itemSize], q->itemSize);
+        q->head = (q->head + 1) % q->length;
+        q->count--;
+        pthread_cond_broadcast(&q->changed);
+        ret = pdPASS;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ret;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    UBaseType_t n;
+
+    pthread_mutex_lock(&q->lock);
+    n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+uint64_t w5500_sim_shim_bus_ns(void)
+{
+    uint64_t ns;
+
+    pthread_mutex_lock(&hwiLock);
+    ns = busNs;
+    pthread_mutex_unlock(&hwiLock);
+    return ns;
+}
+
+uint32_t w5500_sim_shim_opens(void)
+{
+    return opens;
+}
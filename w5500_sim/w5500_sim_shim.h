@@ -0,0 +1,32 @@
+/*
+ *  ======== w5500_sim_shim.h ========
+ *  Host implementation of the TI SPI, GPIO, HwiP and Display APIs and of
+ *  the FreeRTOS queue calls, wired to the W5500 model.
+ *
+ *  SPI_MODE_CALLBACK transfers complete on a worker thread that stands in
+ *  for the DMA interrupt: the callback runs there with "interrupts
+ *  disabled" (the HwiP mutex held), as on the target. Driving
+ *  CONFIG_GPIO_SPI_CONTROLLER_CSN frames the model's SPI transactions, and
+ *  a falling INTn edge calls the callback registered on W5500_SIM_INT_GPIO.
+ */
+#ifndef W5500_SIM_SHIM_H_
+#define W5500_SIM_SHIM_H_
+
+#include <stdint.h>
+
+#include "ti_drivers_config.h"
+
+/* Pin the model's INTn drives, the driver's default W5500_INT_GPIO */
+#define W5500_SIM_INT_GPIO CONFIG_SPI_PERIPHERAL_READY
+
+/*
+ *  ======== w5500_sim_shim_bus_ns ========
+ *  Time the SPI bus has spent clocking data since start, in ns, from each
+ *  transfer's byte count at the bit rate it was opened with.
+ */
+uint64_t w5500_sim_shim_bus_ns(void);
+
+/* Number of SPI_open() calls, i.e. bus reconfigurations */
+uint32_t w5500_sim_shim_opens(void);
+
+#endif /* W5500_SIM_SHIM_H_ */